@@ -55,7 +55,10 @@ static QString stripTemplateArgs(const QString &name)
     return pos < 0 ? name : name.left(pos);
 }
 
-AbstractMetaBuilder::AbstractMetaBuilder() : m_currentClass(0), m_logDirectory(QString('.')+QDir::separator())
+AbstractMetaBuilder::AbstractMetaBuilder() : m_currentClass(0), m_logDirectory(QString('.')+QDir::separator()),
+                                             m_skipFunctionBodies(false), m_parallelParsing(false),
+                                             m_typeCaching(true), m_typeCacheHits(0), m_typeCacheMisses(0),
+                                             m_control(0), m_parser(0), m_codeModel(0)
 {
 }
 
@@ -65,6 +68,10 @@ AbstractMetaBuilder::~AbstractMetaBuilder()
     qDeleteAll(m_globalFunctions);
     qDeleteAll(m_templates);
     qDeleteAll(m_metaClasses);
+    clearTypeCache();
+    delete m_parser;
+    delete m_control;
+    delete m_codeModel;
 }
 
 void AbstractMetaBuilder::checkFunctionModifications()
@@ -325,20 +332,51 @@ bool AbstractMetaBuilder::build(QIODevice* input)
             return false;
     }
 
-    TypeDatabase* types = TypeDatabase::instance();
-
     QByteArray contents = input->readAll();
     input->close();
 
-    Control control;
-    Parser p(&control);
-    pool __pool;
+    return build(contents.constData(), contents.size());
+}
+
+bool AbstractMetaBuilder::build(const char* contents, std::size_t size)
+{
+    Q_ASSERT(contents);
 
-    TranslationUnitAST* ast = p.parse(contents, contents.size(), &__pool);
+    TypeDatabase* types = TypeDatabase::instance();
+
+    // lexerSink() may have lexed most of the translation unit already
+    if (!m_parser) {
+        m_control = new Control;
+        m_parser = new Parser(m_control);
+    }
+    m_control->setSkipFunctionBody(m_skipFunctionBodies);
+    m_parser->setParallel(m_parallelParsing);
+    pool __pool;
 
-    CodeModel model;
-    Binder binder(&model, p.location());
-    m_dom = binder.run(ast);
+    // each declaration is bound as soon as it is parsed, and its nodes are
+    // given back, the pool never holds the tree of the translation unit
+    // the keys of the type cache point into the code model
+    clearTypeCache();
+    delete m_codeModel;
+    m_codeModel = new CodeModel;
+    QTime bindTimer;
+    bindTimer.start();
+    Binder binder(m_codeModel, m_parser->location());
+    m_parser->setDeclarationConsumer(&binder);
+    m_parser->parse(contents, size, &__pool);
+    m_dom = binder.finish();
+    ReportHandler::debugSparse(QString("binder: %1 scopes found in the index, %2 by walking the code model")
+                               .arg(qulonglong(binder.indexedScopeLookups())).arg(qulonglong(binder.scopeWalks())));
+    int itemCount = m_codeModel->itemCount();
+    qulonglong itemMemory = m_codeModel->itemMemory();
+    ReportHandler::debugSparse(QString("code model: %1 items in %2 bytes, %3 per item, parsed and bound in %4 ms")
+                               .arg(itemCount).arg(itemMemory).arg(itemCount ? itemMemory / itemCount : 0)
+                               .arg(bindTimer.elapsed()));
+
+    delete m_parser;
+    delete m_control;
+    m_parser = 0;
+    m_control = 0;
 
     pushScope(model_dynamic_cast<ScopeModelItem>(m_dom));
 
@@ -387,8 +425,10 @@ bool AbstractMetaBuilder::build(QIODevice* input)
     foreach (NamespaceModelItem item, namespaceTypeValues) {
         ReportHandler::progress("Generating namespace model...");
         AbstractMetaClass *metaClass = traverseNamespace(item);
-        if (metaClass)
+        if (metaClass) {
             m_metaClasses << metaClass;
+            clearTypeCache();
+        }
     }
     ReportHandler::flush();
 
@@ -571,6 +611,7 @@ bool AbstractMetaBuilder::build(QIODevice* input)
 
     // sort all classes topologically
     m_metaClasses = classesTopologicalSorted();
+    clearTypeCache();
 
     foreach (AbstractMetaClass* cls, m_metaClasses) {
 //         setupEquals(cls);
@@ -598,6 +639,8 @@ bool AbstractMetaBuilder::build(QIODevice* input)
         m_globalFunctions << metaFunc;
     }
 
+    ReportHandler::debugSparse(QString("type cache: %1 hits, %2 misses").arg(m_typeCacheHits).arg(m_typeCacheMisses));
+
     std::puts("");
     return true;
 }
@@ -609,11 +652,39 @@ void AbstractMetaBuilder::setLogDirectory(const QString& logDir)
        m_logDirectory.append(QDir::separator());
 }
 
+LexerSink AbstractMetaBuilder::lexerSink(std::string& buffer)
+{
+    if (!m_parser) {
+        m_control = new Control;
+        m_parser = new Parser(m_control);
+    }
+    return m_parser->sink(buffer);
+}
+
+void AbstractMetaBuilder::setSkipFunctionBodies(bool skip)
+{
+    m_skipFunctionBodies = skip;
+}
+
+void AbstractMetaBuilder::setParallelParsing(bool enable)
+{
+    m_parallelParsing = enable;
+}
+
+void AbstractMetaBuilder::setTypeCaching(bool enable)
+{
+    m_typeCaching = enable;
+    clearTypeCache();
+}
+
 void AbstractMetaBuilder::addAbstractMetaClass(AbstractMetaClass *cls)
 {
     if (!cls)
         return;
 
+    // the base classes of the classes the types are used in may change
+    clearTypeCache();
+
     cls->setOriginalAttributes(cls->attributes());
     if (cls->typeEntry()->isContainer()) {
         m_templates << cls;
@@ -916,6 +987,7 @@ AbstractMetaEnum* AbstractMetaBuilder::traverseEnum(EnumModelItem enumItem, Abst
             nspace = QStringList(names.mid(0, names.size() - 1)).join("::");
         typeEntry = new EnumTypeEntry(nspace, enumName, 0);
         TypeDatabase::instance()->addType(typeEntry);
+        clearTypeCache();
     } else if (!enumItem->isAnonymous()) {
         typeEntry = TypeDatabase::instance()->findType(qualifiedName);
     } else {
@@ -1010,6 +1082,7 @@ AbstractMetaEnum* AbstractMetaBuilder::traverseEnum(EnumModelItem enumItem, Abst
         name += e->name();
         EnumValueTypeEntry* enumValue = new EnumValueTypeEntry(name, e->value(), static_cast<EnumTypeEntry*>(typeEntry), typeEntry->version());
         TypeDatabase::instance()->addType(enumValue);
+        clearTypeCache();
     }
 
     return metaEnum;
@@ -1143,6 +1216,7 @@ AbstractMetaClass* AbstractMetaBuilder::traverseClass(ClassModelItem classItem)
                 cl->setEnclosingClass(metaClass);
                 metaClass->addInnerClass(cl);
                 m_metaClasses << cl;
+                clearTypeCache();
             }
         }
 
@@ -2071,6 +2145,91 @@ static const TypeEntry* findTypeEntryUsingContext(const AbstractMetaClass* metaC
 AbstractMetaType* AbstractMetaBuilder::translateType(const TypeInfo& _typei, bool *ok, bool resolveType, bool resolveScope)
 {
     Q_ASSERT(ok);
+    if (!m_typeCaching)
+        return translateTypeUncached(_typei, ok, resolveType, resolveScope);
+
+    if (!m_codeModel || _typei.isFunctionPointer())
+        return translateTypeUncached(_typei, ok, resolveType, resolveScope);
+
+    // The lookups depend on the class the type is used in and on the scopes
+    // its typedefs are resolved in. The classes and the type entries only
+    // change while the classes are traversed, which clears the cache.
+    TypeCacheKey key;
+    key.name = m_codeModel->qualifiedName(_typei.qualifiedName());
+    key.flags = uint(_typei.isConstant()) | uint(_typei.isVolatile()) << 1
+                | uint(_typei.isReference()) << 2 | uint(_typei.indirections()) << 3;
+    key.arrayElements = _typei.arrayElements();
+    key.resolveType = resolveType;
+    key.resolveScope = resolveScope;
+    key.currentClass = m_currentClass;
+    key.scopes = m_scopes;
+
+    QHash<TypeCacheKey, TypeCacheEntry>::const_iterator it = m_typeCache.constFind(key);
+    if (it != m_typeCache.constEnd()) {
+        ++m_typeCacheHits;
+        *ok = it->ok;
+        return it->type ? cloneType(it->type) : 0;
+    }
+
+    ++m_typeCacheMisses;
+    int warnings = ReportHandler::warningCount() + ReportHandler::suppressedCount();
+    AbstractMetaType* type = translateTypeUncached(_typei, ok, resolveType, resolveScope);
+
+    // a translation that warned must warn again
+    if (ReportHandler::warningCount() + ReportHandler::suppressedCount() == warnings) {
+        TypeCacheEntry entry = { type ? cloneType(type) : 0, *ok };
+        m_typeCache.insert(key, entry);
+    }
+
+    return type;
+}
+
+bool AbstractMetaBuilder::TypeCacheKey::operator==(const TypeCacheKey& other) const
+{
+    return name == other.name && flags == other.flags
+           && resolveType == other.resolveType && resolveScope == other.resolveScope
+           && currentClass == other.currentClass && scopes == other.scopes
+           && arrayElements == other.arrayElements;
+}
+
+uint qHash(const AbstractMetaBuilder::TypeCacheKey& key)
+{
+    uint hash = qHash(key.name) ^ (key.flags << 2) ^ (uint(key.resolveType) | uint(key.resolveScope) << 1);
+    hash = hash * 31 + qHash(key.currentClass);
+    foreach (const ScopeModelItem& scope, key.scopes)
+        hash = hash * 31 + qHash(scope.constData());
+    return hash * 31 + uint(key.arrayElements.size());
+}
+
+// a deep copy, made with createMetaType(), that owns its instantiations
+AbstractMetaType* AbstractMetaBuilder::cloneType(const AbstractMetaType* type)
+{
+    AbstractMetaType* clone = createMetaType();
+    clone->setTypeEntry(type->typeEntry());
+    clone->setTypeUsagePattern(type->typeUsagePattern());
+    clone->setConstant(type->isConstant());
+    clone->setReference(type->isReference());
+    clone->setIndirections(type->indirections());
+    clone->setArrayElementCount(type->arrayElementCount());
+    clone->setArrayElementType(type->arrayElementType() ? cloneType(type->arrayElementType()) : 0);
+    clone->setOriginalTypeDescription(type->originalTypeDescription());
+    clone->setOriginalTemplateType(type->originalTemplateType());
+
+    foreach (AbstractMetaType* instantiation, type->instantiations())
+        clone->addInstantiation(cloneType(instantiation), true);
+
+    return clone;
+}
+
+void AbstractMetaBuilder::clearTypeCache()
+{
+    foreach (const TypeCacheEntry& entry, m_typeCache)
+        delete entry.type;
+    m_typeCache.clear();
+}
+
+AbstractMetaType* AbstractMetaBuilder::translateTypeUncached(const TypeInfo& _typei, bool *ok, bool resolveType, bool resolveScope)
+{
     *ok = true;
 
     // 1. Test the type info without resolving typedefs in case this is present in the
@@ -2106,7 +2265,7 @@ AbstractMetaType* AbstractMetaBuilder::translateType(const TypeInfo& _typei, boo
         return 0;
     }
 
-    TypeParser::Info typeInfo = TypeParser::parse(typei.toString());
+    TypeParser::Info typeInfo = TypeParser::parse(typei);
     if (typeInfo.is_busted) {
         *ok = false;
         return 0;
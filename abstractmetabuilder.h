@@ -25,6 +25,7 @@
 #define ABSTRACTMETABUILDER_H
 
 #include "parser/codemodel.h"
+#include "parser/lexer.h"
 #include "abstractmetalang.h"
 #include "typesystem.h"
 #include "typeparser.h"
@@ -33,6 +34,7 @@
 #include <QFileInfo>
 
 class TypeDatabase;
+class Parser;
 
 class APIEXTRACTOR_API AbstractMetaBuilder
 {
@@ -94,7 +96,43 @@ public:
     void dumpLog();
 
     bool build(QIODevice* input);
+    /**
+    *   Parses the preprocessed translation unit in \p contents. The buffer is
+    *   tokenized in place, so it must stay alive until build() returns.
+    */
+    bool build(const char* contents, std::size_t size);
+    /**
+    *   Returns an output iterator for the preprocessor that appends the
+    *   translation unit to \p buffer and lexes it while it is being written.
+    *   build() must then be called with the complete \p buffer.
+    */
+    LexerSink lexerSink(std::string& buffer);
     void setLogDirectory(const QString& logDir);
+    /**
+    *   Jumps over the bodies of function definitions instead of parsing
+    *   them, nothing in the code model depends on them. Disabled by default.
+    */
+    void setSkipFunctionBodies(bool skip);
+    /**
+    *   Parses the top-level declarations on a thread pool, in chunks split
+    *   outside of braces. The code model is the same. Disabled by default.
+    */
+    void setParallelParsing(bool enable);
+    /**
+    *   Remembers the types made by translateType() by type and context, the
+    *   current class and scopes, and hands out copies of them, so that types
+    *   like "const QString&" are resolved once in a scope. Translations that
+    *   warned are not remembered. Enabled by default.
+    */
+    void setTypeCaching(bool enable);
+    int typeCacheHits() const
+    {
+        return m_typeCacheHits;
+    }
+    int typeCacheMisses() const
+    {
+        return m_typeCacheMisses;
+    }
 
     void figureOutEnumValuesForClass(AbstractMetaClass *metaClass, QSet<AbstractMetaClass *> *classes);
     int figureOutEnumValue(const QString &name, int value, AbstractMetaEnum *meta_enum, AbstractMetaFunction *metaFunction = 0);
@@ -149,6 +187,9 @@ public:
                                   int argumentIndex);
     AbstractMetaType* translateType(double vr, const AddedFunction::TypeInfo& typeInfo);
     AbstractMetaType *translateType(const TypeInfo &type, bool *ok, bool resolveType = true, bool resolveScope = true);
+    AbstractMetaType *translateTypeUncached(const TypeInfo &type, bool *ok, bool resolveType, bool resolveScope);
+    AbstractMetaType *cloneType(const AbstractMetaType *type);
+    void clearTypeCache();
 
     int findOutValueFromString(const QString& stringValue, bool& ok);
 
@@ -266,6 +307,40 @@ private:
 
     QString m_logDirectory;
     QFileInfo m_globalHeader;
+    bool m_skipFunctionBodies;
+    bool m_parallelParsing;
+
+    // what a translateType() depends on: the type, how it is resolved and
+    // where it is used. Types of function pointers aren't cached.
+    struct TypeCacheKey {
+        const QualifiedName *name;  // interned by m_codeModel
+        uint flags;                 // const, volatile, reference, indirections
+        QStringList arrayElements;
+        bool resolveType;
+        bool resolveScope;
+        const AbstractMetaClass *currentClass;
+        QList<ScopeModelItem> scopes;
+
+        bool operator==(const TypeCacheKey &other) const;
+    };
+    friend uint qHash(const TypeCacheKey &key);
+
+    // the types translateType() made, or 0 when it failed
+    struct TypeCacheEntry {
+        AbstractMetaType *type;
+        bool ok;
+    };
+    QHash<TypeCacheKey, TypeCacheEntry> m_typeCache;
+    bool m_typeCaching;
+    int m_typeCacheHits;
+    int m_typeCacheMisses;
+
+    // the parser lexing the output of lexerSink(), until build() takes it
+    Control* m_control;
+    Parser* m_parser;
+
+    // the items of m_dom belong to it, and go away with it
+    CodeModel* m_codeModel;
 };
 
 #endif // ABSTRACTMETBUILDER_H
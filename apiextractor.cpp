@@ -26,6 +26,7 @@
 #include <QDebug>
 #include <QTemporaryFile>
 #include <iostream>
+#include <sstream>
 
 #include "reporthandler.h"
 #include "typesystem.h"
@@ -34,12 +35,19 @@
 #include "abstractmetabuilder.h"
 #include "apiextractorversion.h"
 #include "typedatabase.h"
+#include "parser/lexer.h"
+#include "parallelpreprocessor.h"
 
 static bool preprocess(const QString& sourceFile,
-                       QFile& targetFile,
-                       const QStringList& includes);
-
-ApiExtractor::ApiExtractor() : m_builder(0)
+                       std::string& result,
+                       const QStringList& includes,
+                       const QString& cacheDir,
+                       bool parallel,
+                       std::string* profileReport,
+                       LexerSink* sink);
+
+ApiExtractor::ApiExtractor() : m_builder(0), m_parallelPreprocessing(false), m_skipFunctionBodies(true),
+                               m_lexWhilePreprocessing(false), m_parallelParsing(false)
 {
     // Environment TYPESYSTEMPATH
     QString envTypesystemPaths = getenv("TYPESYSTEMPATH");
@@ -79,6 +87,36 @@ void ApiExtractor::setLogDirectory(const QString& logDir)
     m_logDirectory = logDir;
 }
 
+void ApiExtractor::setCacheDirectory(const QString& cacheDir)
+{
+    m_cacheDirectory = cacheDir;
+}
+
+void ApiExtractor::setParallelPreprocessing(bool enable)
+{
+    m_parallelPreprocessing = enable;
+}
+
+void ApiExtractor::setPreprocessorProfile(const QString& fileName)
+{
+    m_preprocessorProfile = fileName;
+}
+
+void ApiExtractor::setSkipFunctionBodies(bool skip)
+{
+    m_skipFunctionBodies = skip;
+}
+
+void ApiExtractor::setLexWhilePreprocessing(bool enable)
+{
+    m_lexWhilePreprocessing = enable;
+}
+
+void ApiExtractor::setParallelParsing(bool enable)
+{
+    m_parallelParsing = enable;
+}
+
 void ApiExtractor::setCppFileName(const QString& cppFileName)
 {
     m_cppFileName = cppFileName;
@@ -227,27 +265,57 @@ bool ApiExtractor::run()
         return false;
     }
 
-    QTemporaryFile ppFile;
-#ifndef NDEBUG
-    ppFile.setAutoRemove(false);
-#endif
-    // run rpp pre-processor
-    if (!preprocess(m_cppFileName, ppFile, m_includePaths)) {
+    AbstractMetaBuilder* builder = new AbstractMetaBuilder;
+
+    // run rpp pre-processor, its output is handed to the parser without copies
+    std::string ppResult;
+    std::string ppProfileReport;
+    LexerSink sink = builder->lexerSink(ppResult);
+    if (!preprocess(m_cppFileName, ppResult, m_includePaths, m_cacheDirectory, m_parallelPreprocessing,
+                    m_preprocessorProfile.isEmpty() ? 0 : &ppProfileReport,
+                    m_lexWhilePreprocessing ? &sink : 0)) {
         std::cerr << "Preprocessor failed on file: " << qPrintable(m_cppFileName);
+        delete builder;
         return false;
     }
-    ppFile.seek(0);
-    m_builder = new AbstractMetaBuilder;
+
+    // keep a copy of the preprocessed file around when debugging
+    if (ReportHandler::debugLevel() == ReportHandler::FullDebug) {
+        QTemporaryFile ppFile;
+        ppFile.setAutoRemove(false);
+        if (ppFile.open()) {
+            ppFile.write(ppResult.c_str(), ppResult.length());
+            ReportHandler::debugFull(QString("Preprocessed file written to %1").arg(ppFile.fileName()));
+        }
+    }
+
+    m_builder = builder;
     m_builder->setLogDirectory(m_logDirectory);
     m_builder->setGlobalHeader(m_cppFileName);
-    m_builder->build(&ppFile);
+    m_builder->setSkipFunctionBodies(m_skipFunctionBodies);
+    m_builder->setParallelParsing(m_parallelParsing);
+    m_builder->build(ppResult.c_str(), ppResult.length());
+
+    if (!m_preprocessorProfile.isEmpty()) {
+        QFile profileFile(m_preprocessorProfile);
+        if (profileFile.open(QFile::WriteOnly | QFile::Truncate)) {
+            profileFile.write(ppProfileReport.c_str(), ppProfileReport.length());
+            ReportHandler::debugSparse(QString("Preprocessor profile written to %1").arg(m_preprocessorProfile));
+        } else {
+            ReportHandler::warning(QString("Can't write the preprocessor profile to %1").arg(m_preprocessorProfile));
+        }
+    }
 
     return true;
 }
 
 static bool preprocess(const QString& sourceFile,
-                       QFile& targetFile,
-                       const QStringList& includes)
+                       std::string& result,
+                       const QStringList& includes,
+                       const QString& cacheDir,
+                       bool parallel,
+                       std::string* profileReport,
+                       LexerSink* sink)
 {
     rpp::pp_environment env;
     rpp::pp preprocess(env);
@@ -279,25 +347,58 @@ static bool preprocess(const QString& sourceFile,
     }
     QDir::setCurrent(sourceInfo.absolutePath());
 
-    std::string result;
-    result.reserve(20 * 1024);  // 20K
+    rpp::pp_cache* cache = 0;
+    if (!parallel && !cacheDir.isEmpty() && QDir().mkpath(cacheDir)) {
+        cache = new rpp::pp_cache(QDir(cacheDir).absolutePath().toStdString());
+
+        // relative include paths are resolved against the current directory
+        std::string context = sourceInfo.absolutePath().toStdString();
+        for (std::vector<std::string>::const_iterator it = preprocess.include_paths_begin();
+             it != preprocess.include_paths_end(); ++it) {
+            context += '\n';
+            context += *it;
+        }
+        cache->set_context(context);
+        preprocess.set_cache(cache);
+    }
+
+    result.reserve(1024 * 1024);  // 1M, a Qt module expands to several megabytes
 
     result += "# 1 \"builtins\"\n";
     result += "# 1 \"";
     result += sourceFile.toStdString();
     result += "\"\n";
 
-    preprocess.file(sourceInfo.fileName().toStdString(),
-                    rpp::pp_output_iterator<std::string> (result));
+    rpp::pp_profile profile;
+    if (profileReport)
+        preprocess.set_profile(&profile);
+
+    if (!parallel || !preprocessInParallel(preprocess, env, sourceInfo.fileName(), result)) {
+        if (sink) {
+            preprocess.file(sourceInfo.fileName().toStdString(), *sink);
+        } else {
+            preprocess.file(sourceInfo.fileName().toStdString(),
+                            rpp::pp_output_iterator<std::string> (result));
+        }
+    }
 
     QDir::setCurrent(currentDir);
 
-    if (!targetFile.open(QIODevice::ReadWrite | QIODevice::Text)) {
-        std::cerr << "Failed to write preprocessed file: " << qPrintable(targetFile.fileName()) << std::endl;
-        return false;
+    ReportHandler::debugSparse(QString("Include resolution cache: %1 hits, %2 misses")
+                               .arg(preprocess.include_cache_hits()).arg(preprocess.include_cache_misses()));
+
+    if (cache) {
+        ReportHandler::debugSparse(QString("Preprocessor cache: %1 hits, %2 misses")
+                                   .arg(cache->hits()).arg(cache->misses()));
+        delete cache;
+    }
+
+    if (profileReport) {
+        std::ostringstream report;
+        profile.write_json(report, env.symbols().count());
+        *profileReport = report.str();
     }
 
-    targetFile.write(result.c_str(), result.length());
     return true;
 }
 
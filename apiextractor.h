@@ -48,6 +48,47 @@ public:
     void addIncludePath(const QString& path);
     void addIncludePath(const QStringList& paths);
     void setLogDirectory(const QString& logDir);
+    /**
+    *   Enables the on-disk cache of preprocessed headers, unchanged headers
+    *   are replayed from \p cacheDir instead of being preprocessed again.
+    *   The cache is disabled by default.
+    */
+    void setCacheDirectory(const QString& cacheDir);
+    /**
+    *   Preprocesses the top-level includes of the global header on a thread
+    *   pool when the header is made only of #include directives. The first
+    *   include is preprocessed before the others, which start from the macros
+    *   it defined. Includes that depend on macros changed by a previous
+    *   include are preprocessed again in order. The preprocessor cache is not
+    *   used in this mode.
+    *   Disabled by default.
+    */
+    void setParallelPreprocessing(bool enable);
+    /**
+    *   Profiles the preprocessor and writes a JSON report to \p fileName at
+    *   the end of run(): time and bytes per header, expansions and generated
+    *   bytes per macro. Headers preprocessed on the thread pool in parallel
+    *   mode are not profiled. Disabled by default.
+    */
+    void setPreprocessorProfile(const QString& fileName);
+    /**
+    *   Jumps over the bodies of inline functions instead of parsing them.
+    *   Enabled by default.
+    */
+    void setSkipFunctionBodies(bool skip);
+    /**
+    *   Lexes the preprocessed translation unit while the preprocessor writes
+    *   it instead of in a second pass over the text. Has no effect in parallel
+    *   preprocessing mode. Disabled by default.
+    */
+    void setLexWhilePreprocessing(bool enable);
+    /**
+    *   Parses the top-level declarations of the translation unit on a thread
+    *   pool. The input is split after declarations outside of any braces, so
+    *   namespaces are parsed whole; the code model is the same as when parsing
+    *   in one thread. Disabled by default.
+    */
+    void setParallelParsing(bool enable);
     APIEXTRACTOR_DEPRECATED(void setApiVersion(double version));
     void setApiVersion(const QString& package, const QByteArray& version);
     void setDropTypeEntries(QString dropEntries);
@@ -73,6 +114,12 @@ private:
     QStringList m_includePaths;
     AbstractMetaBuilder* m_builder;
     QString m_logDirectory;
+    QString m_cacheDirectory;
+    bool m_parallelPreprocessing;
+    QString m_preprocessorProfile;
+    bool m_skipFunctionBodies;
+    bool m_lexWhilePreprocessing;
+    bool m_parallelParsing;
 
     // disable copy
     ApiExtractor(const ApiExtractor&);
@@ -0,0 +1,290 @@
+/*
+ * This file is part of the API Extractor project.
+ *
+ * Copyright (C) 2011 Nokia Corporation and/or its subsidiary(-ies).
+ *
+ * Contact: PySide team <contact@pyside.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+
+#include "parallelpreprocessor.h"
+#include <QFile>
+#include <QList>
+#include <QThreadPool>
+#include <QRunnable>
+#include <algorithm>
+#include <map>
+#include <set>
+#include <vector>
+
+#include "reporthandler.h"
+#include "parser/rpp/pp.h"
+
+struct IncludeDirective
+{
+    std::string text;
+    int line;
+};
+
+// Collects the macros a preprocessor looks up, by the hash of their name, and
+// the names of those it defines or removes. Looking up a name that merely
+// shares its hash with a changed macro is taken as a conflict, which costs a
+// serial pass but is never wrong.
+class MacroUsage : public rpp::pp_macro_observer
+{
+public:
+    MacroUsage() : m_compactAt(4096) {}
+
+    virtual void macro_resolved(const rpp::pp_fast_string& name, const rpp::pp_macro*)
+    {
+        touch(name.hash());
+    }
+
+    virtual void macro_bound(const rpp::pp_macro& macro)
+    {
+        touch(macro.name->hash());
+        changed.insert(std::string(macro.name->begin(), macro.name->end()));
+    }
+
+    virtual void macro_unbound(const rpp::pp_fast_string& name)
+    {
+        touch(name.hash());
+        changed.insert(std::string(name.begin(), name.end()));
+    }
+
+    // sorts the hashes looked up and drops the duplicates
+    void finish()
+    {
+        std::sort(touched.begin(), touched.end());
+        touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+    }
+
+    std::vector<std::size_t> touched;
+    std::set<std::string> changed;
+
+private:
+    void touch(std::size_t hash)
+    {
+        touched.push_back(hash);
+
+        // the same few thousand names are looked up over and over
+        if (touched.size() >= m_compactAt) {
+            finish();
+            m_compactAt = 2 * touched.size() + 4096;
+        }
+    }
+
+    std::size_t m_compactAt;
+};
+
+// Preprocesses one top-level include, starting from a copy of the macros
+// defined before the global header
+class IncludeTask : public QRunnable
+{
+public:
+    IncludeTask(const rpp::pp_environment& prelude, const std::vector<std::string>& includePaths,
+                const std::string& fileName, const IncludeDirective& directive)
+        : env(prelude), include(directive), m_includePaths(includePaths), m_fileName(fileName)
+    {
+        setAutoDelete(false);
+    }
+
+    void run()
+    {
+        env.set_observer(&usage);
+        rpp::pp preprocess(env);
+        for (std::size_t i = 0; i < m_includePaths.size(); ++i)
+            preprocess.push_include_path(m_includePaths[i]);
+
+        env.current_file = m_fileName;
+        preprocess(include.text.c_str(), include.text.c_str() + include.text.size(),
+                   rpp::pp_output_iterator<std::string>(output));
+        env.set_observer(0);
+        usage.finish();
+    }
+
+    rpp::pp_environment env;
+    IncludeDirective include;
+    MacroUsage usage;
+    std::string output;
+
+private:
+    std::vector<std::string> m_includePaths;
+    std::string m_fileName;
+};
+
+// Returns false unless the file has nothing but #include directives,
+// comments and blank lines.
+static bool splitIncludes(const QByteArray& contents, std::vector<IncludeDirective>* includes)
+{
+    enum { Code, LineComment, BlockComment, String } state = Code;
+    std::string line;
+    int lineNumber = 1;
+
+    for (int i = 0; i <= contents.size(); ++i) {
+        char c = i < contents.size() ? contents.at(i) : '\n';
+        char next = i + 1 < contents.size() ? contents.at(i + 1) : '\0';
+
+        if (c == '\n') {
+            if (state == LineComment)
+                state = Code;
+
+            std::size_t begin = line.find_first_not_of(" \t\r");
+            if (begin != std::string::npos) {
+                std::size_t directive = line.find_first_not_of(" \t", begin + 1);
+                if (line[begin] != '#' || directive == std::string::npos
+                    || line.compare(directive, 7, "include") != 0 || line[line.size() - 1] == '\\')
+                    return false;
+
+                // not #include_next, #includefoo and such
+                char after = directive + 7 < line.size() ? line[directive + 7] : '\0';
+                if (after != ' ' && after != '\t' && after != '<' && after != '"')
+                    return false;
+
+                IncludeDirective include;
+                include.text = line.substr(begin) + '\n';
+                include.line = lineNumber;
+                includes->push_back(include);
+            }
+
+            line.clear();
+            ++lineNumber;
+            continue;
+        }
+
+        switch (state) {
+        case Code:
+            if (c == '/' && next == '/') {
+                state = LineComment;
+            } else if (c == '/' && next == '*') {
+                state = BlockComment;
+                line += ' ';
+                ++i;
+            } else {
+                if (c == '"')
+                    state = String;
+                line += c;
+            }
+            break;
+        case String:
+            if (c == '\\' && next != '\n') {
+                line += c;
+                c = next;
+                ++i;
+            } else if (c == '"') {
+                state = Code;
+            }
+            line += c;
+            break;
+        case BlockComment:
+            if (c == '*' && next == '/') {
+                state = Code;
+                ++i;
+            }
+            break;
+        case LineComment:
+            break;
+        }
+    }
+
+    return state == Code || state == LineComment;
+}
+
+static std::string lineMarker(const std::string& fileName, int line)
+{
+    std::string marker;
+    rpp::_PP_internal::output_line(fileName, line, std::back_inserter(marker));
+    return marker;
+}
+
+bool preprocessInParallel(rpp::pp& preprocess, rpp::pp_environment& env,
+                          const QString& fileName, std::string& result)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    std::vector<IncludeDirective> includes;
+    if (!splitIncludes(file.readAll(), &includes) || includes.size() < 3)
+        return false;
+
+    std::vector<std::string> includePaths(preprocess.include_paths_begin(), preprocess.include_paths_end());
+    std::string ppFileName = fileName.toStdString();
+
+    // the includes of a global header share most of what the first one
+    // pulls in, qglobal.h and the rest of QtCore for a Qt module; started
+    // before it, each of them would read the guards it defines and conflict
+    result += lineMarker(ppFileName, includes[0].line);
+    env.current_file = ppFileName;
+    preprocess(includes[0].text.c_str(), includes[0].text.c_str() + includes[0].text.size(),
+               rpp::pp_output_iterator<std::string>(result));
+
+    QList<IncludeTask*> tasks;
+    for (std::size_t i = 1; i < includes.size(); ++i)
+        tasks << new IncludeTask(env, includePaths, ppFileName, includes[i]);
+
+    QThreadPool pool;
+    foreach (IncludeTask* task, tasks)
+        pool.start(task);
+    pool.waitForDone();
+
+    // the macros changed by the includes merged so far, by the hash of their name
+    std::map<std::size_t, std::string> changed;
+    int conflicts = 0;
+    foreach (IncludeTask* task, tasks) {
+        result += lineMarker(ppFileName, task->include.line);
+
+        std::map<std::size_t, std::string>::const_iterator conflict = changed.end();
+        for (std::vector<std::size_t>::const_iterator it = task->usage.touched.begin();
+             conflict == changed.end() && it != task->usage.touched.end(); ++it)
+            conflict = changed.find(*it);
+
+        std::set<std::string> changedNames;
+        if (conflict == changed.end()) {
+            result += task->output;
+            for (std::set<std::string>::const_iterator it = task->usage.changed.begin();
+                 it != task->usage.changed.end(); ++it) {
+                if (rpp::pp_macro* macro = task->env.resolve(it->c_str(), it->size()))
+                    env.bind(macro->name, *macro);
+                else
+                    env.unbind(it->c_str(), it->size());
+            }
+            changedNames = task->usage.changed;
+        } else {
+            ++conflicts;
+            ReportHandler::debugSparse(QString("%1 depends on macro '%2' changed by a previous include, preprocessing it again")
+                                       .arg(QString::fromStdString(task->include.text).trimmed())
+                                       .arg(QString::fromStdString(conflict->second)));
+
+            MacroUsage usage;
+            env.set_observer(&usage);
+            env.current_file = ppFileName;
+            preprocess(task->include.text.c_str(), task->include.text.c_str() + task->include.text.size(),
+                       rpp::pp_output_iterator<std::string>(result));
+            env.set_observer(0);
+            changedNames = usage.changed;
+        }
+
+        for (std::set<std::string>::const_iterator it = changedNames.begin(); it != changedNames.end(); ++it)
+            changed[rpp::pp_fast_string(*it).hash()] = *it;
+    }
+
+    ReportHandler::debugSparse(QString("Parallel preprocessing: %1 includes after the first, %2 preprocessed again")
+                               .arg(tasks.size()).arg(conflicts));
+    qDeleteAll(tasks);
+    return true;
+}
@@ -0,0 +1,51 @@
+/*
+ * This file is part of the API Extractor project.
+ *
+ * Copyright (C) 2011 Nokia Corporation and/or its subsidiary(-ies).
+ *
+ * Contact: PySide team <contact@pyside.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+
+#ifndef PARALLELPREPROCESSOR_H
+#define PARALLELPREPROCESSOR_H
+
+#include <QString>
+#include <string>
+
+namespace rpp
+{
+class pp;
+class pp_environment;
+}
+
+/**
+*   Preprocesses the top-level includes of \p fileName, a global header made
+*   only of #include directives, and appends the result to \p result. The
+*   first include is preprocessed by \p preprocess, the others concurrently,
+*   each from a snapshot of \p env taken after the first. The results are
+*   then merged in order: an include that looked at a macro changed by one of
+*   the previous includes would have been preprocessed differently, so it is
+*   preprocessed again by \p preprocess on top of the merged macro state.
+*
+*   Returns false, leaving \p result alone, when the file has anything but
+*   #include directives or fewer than three of them.
+*/
+bool preprocessInParallel(rpp::pp& preprocess, rpp::pp_environment& env,
+                          const QString& fileName, std::string& result);
+
+#endif // PARALLELPREPROCESSOR_H
@@ -863,7 +863,9 @@ template <class _Tp>
 _Tp *CreateNode(pool *memory_pool)
 {
     _Tp *node = reinterpret_cast<_Tp*>(memory_pool->allocate(sizeof(_Tp), strideof(_Tp)));
+    std::memset(node, 0, sizeof(_Tp));
     node->kind = _Tp::__node_kind;
+    memory_pool->count_node(_Tp::__node_kind, sizeof(_Tp));
     return node;
 }
 
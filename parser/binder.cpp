@@ -41,6 +41,8 @@ Binder::Binder(CodeModel *__model, LocationManager &__location, Control *__contr
         _M_token_stream(&_M_location.token_stream),
         _M_control(__control),
         _M_current_function_type(CodeModel::Normal),
+        _M_indexed_lookups(0),
+        _M_scope_walks(0),
         type_cc(this),
         name_cc(this),
         decl_cc(this)
@@ -61,9 +63,8 @@ Binder::~Binder()
 FileModelItem Binder::run(AST *node)
 {
     FileModelItem old = _M_current_file;
-    _M_current_access = CodeModel::Public;
 
-    _M_current_file = model()->create<FileModelItem>();
+    startFile();
     updateItemPosition(_M_current_file->toItem(), node);
     visit(node);
     FileModelItem result = _M_current_file;
@@ -73,6 +74,34 @@ FileModelItem Binder::run(AST *node)
     return result;
 }
 
+void Binder::declaration(DeclarationAST *node)
+{
+    if (!_M_current_file) {
+        startFile();
+        updateItemPosition(_M_current_file->toItem(), node);
+    }
+
+    visit(node);
+}
+
+FileModelItem Binder::finish()
+{
+    FileModelItem result = _M_current_file;
+    if (!result)
+        result = model()->create<FileModelItem>();
+
+    _M_current_file = FileModelItem();
+
+    return result;
+}
+
+void Binder::startFile()
+{
+    _M_current_access = CodeModel::Public;
+    _M_current_file = model()->create<FileModelItem>();
+    _M_scope_index.clear();
+}
+
 ScopeModelItem Binder::currentScope()
 {
     if (_M_current_class)
@@ -277,7 +306,7 @@ void Binder::declare_symbol(SimpleDeclarationAST *node, InitDeclaratorAST *init_
             fun->addArgument(arg);
         }
 
-        fun->setScope(symbolScope->qualifiedName());
+        fun->setScope(symbolScope->internedQualifiedName());
         symbolScope->addFunction(fun);
     } else {
         VariableModelItem var = model()->create<VariableModelItem>();
@@ -300,7 +329,7 @@ void Binder::declare_symbol(SimpleDeclarationAST *node, InitDeclaratorAST *init_
         var->setType(qualifyType(typeInfo, _M_context));
         applyStorageSpecifiers(node->storage_specifiers, model_static_cast<MemberModelItem>(var));
 
-        var->setScope(symbolScope->qualifiedName());
+        var->setScope(symbolScope->internedQualifiedName());
         symbolScope->addVariable(var);
     }
 }
@@ -339,7 +368,7 @@ void Binder::visitFunctionDefinition(FunctionDefinitionAST *node)
 
     FunctionDefinitionModelItem
     old = changeCurrentFunction(_M_model->create<FunctionDefinitionModelItem>());
-    _M_current_function->setScope(functionScope->qualifiedName());
+    _M_current_function->setScope(functionScope->internedQualifiedName());
     updateItemPosition(_M_current_function->toItem(), node);
 
     Q_ASSERT(declarator->id->unqualified_name);
@@ -520,7 +549,7 @@ void Binder::visitTypedef(TypedefAST *node)
         updateItemPosition(typeAlias->toItem(), node);
         typeAlias->setName(alias_name);
         typeAlias->setType(qualifyType(typeInfo, currentScope()->qualifiedName()));
-        typeAlias->setScope(typedefScope->qualifiedName());
+        typeAlias->setScope(typedefScope->internedQualifiedName());
         _M_qualified_types[typeAlias->qualifiedName().join(".")] = QString();
         currentScope()->addTypeAlias(typeAlias);
     } while (it != end);
@@ -538,14 +567,12 @@ void Binder::visitNamespace(NamespaceAST *node)
 
         QStringList qualified_name = scope->qualifiedName();
         qualified_name += name;
-        NamespaceModelItem ns =
-            model_safe_cast<NamespaceModelItem>(_M_model->findItem(qualified_name,
-                                                                   _M_current_file->toItem()));
+        NamespaceModelItem ns = model_safe_cast<NamespaceModelItem>(findScope(qualified_name));
         if (!ns) {
             ns = _M_model->create<NamespaceModelItem>();
             updateItemPosition(ns->toItem(), node);
             ns->setName(name);
-            ns->setScope(scope->qualifiedName());
+            ns->setScope(scope->internedQualifiedName());
         }
         old = changeCurrentNamespace(ns);
 
@@ -560,8 +587,10 @@ void Binder::visitNamespace(NamespaceAST *node)
 
         _M_context.removeLast();
 
-        if (NamespaceModelItem ns = model_static_cast<NamespaceModelItem>(scope))
+        if (NamespaceModelItem ns = model_static_cast<NamespaceModelItem>(scope)) {
             ns->addNamespace(_M_current_namespace);
+            indexScope(_M_current_namespace->qualifiedName(), _M_current_namespace->toItem(), scope->qualifiedName());
+        }
 
         changeCurrentNamespace(old);
     }
@@ -623,11 +652,19 @@ void Binder::visitClassSpecifier(ClassSpecifierAST *node)
     CodeModel::AccessPolicy oldAccessPolicy = changeCurrentAccess(decode_access_policy(node->class_key));
     CodeModel::FunctionType oldFunctionType = changeCurrentFunctionType(CodeModel::Normal);
 
-    _M_current_class->setScope(scope->qualifiedName());
+    _M_current_class->setScope(scope->internedQualifiedName());
     _M_qualified_types[_M_current_class->qualifiedName().join(".")] = QString();
 
     scope->addClass(_M_current_class);
 
+    // under the same names as the scope has it
+    QStringList namespaces = _M_current_namespace ? _M_current_namespace->qualifiedName() : QStringList();
+    QString className = _M_current_class->name();
+    int templateStart = className.indexOf('<');
+    if (templateStart > 0)
+        indexScope(scope->qualifiedName() << className.left(templateStart), _M_current_class->toItem(), namespaces);
+    indexScope(_M_current_class->qualifiedName(), _M_current_class->toItem(), namespaces);
+
     name_cc.run(node->name->unqualified_name);
     _M_context.append(name_cc.name());
     visitNodes(this, node->member_specs);
@@ -671,7 +708,7 @@ void Binder::visitEnumSpecifier(EnumSpecifierAST *node)
     updateItemPosition(_M_current_enum->toItem(), node);
     _M_current_enum->setName(name);
     _M_current_enum->setAnonymous(isAnonymous);
-    _M_current_enum->setScope(enumScope->qualifiedName());
+    _M_current_enum->setScope(enumScope->internedQualifiedName());
 
     _M_qualified_types[_M_current_enum->qualifiedName().join(".")] = QString();
 
@@ -822,7 +859,7 @@ TypeInfo Binder::qualifyType(const TypeInfo &type, const QStringList &context) c
             modified_type.setQualifiedName(expanded);
             return modified_type;
         } else {
-            CodeModelItem scope = model()->findItem(context, _M_current_file->toItem());
+            CodeModelItem scope = findScope(context);
 
             if (ClassModelItem klass = model_dynamic_cast<ClassModelItem> (scope)) {
                 foreach (QString base, klass->baseClasses()) {
@@ -843,6 +880,58 @@ TypeInfo Binder::qualifyType(const TypeInfo &type, const QStringList &context) c
     }
 }
 
+CodeModelItem Binder::findScope(const QStringList &qualifiedName) const
+{
+    QHash<QString, IndexedScope>::const_iterator it = _M_scope_index.constFind(qualifiedName.join("."));
+    if (it != _M_scope_index.constEnd()) {
+        bool found = true;
+        foreach (const QString &ns, it->namespaces) {
+            QHash<QString, IndexedScope>::const_iterator enclosing = _M_scope_index.constFind(ns);
+            if (enclosing == _M_scope_index.constEnd() || enclosing->item->kind() != _CodeModelItem::Kind_Namespace) {
+                found = false;
+                break;
+            }
+        }
+
+        if (found) {
+            ++_M_indexed_lookups;
+            return it->item;
+        }
+    }
+
+    ++_M_scope_walks;
+    return model()->findItem(qualifiedName, _M_current_file->toItem());
+}
+
+void Binder::indexScope(const QStringList &qualifiedName, CodeModelItem item, const QStringList &namespaces)
+{
+    QString key = qualifiedName.join(".");
+    QHash<QString, IndexedScope>::iterator it = _M_scope_index.find(key);
+    if (it != _M_scope_index.end()) {
+        if (it->item.constData() == item.constData())
+            return;
+
+        // findItem() looks for namespaces before classes
+        if (it->item->kind() == _CodeModelItem::Kind_Namespace && item->kind() != _CodeModelItem::Kind_Namespace)
+            return;
+
+        // the scopes in the class this one hides aren't found any more
+        QString prefix = key + QLatin1Char('.');
+        for (it = _M_scope_index.begin(); it != _M_scope_index.end(); ) {
+            if (it.key().startsWith(prefix))
+                it = _M_scope_index.erase(it);
+            else
+                ++it;
+        }
+    }
+
+    IndexedScope scope;
+    scope.item = item;
+    for (int i = 1; i <= namespaces.size(); ++i)
+        scope.namespaces << QStringList(namespaces.mid(0, i)).join(".");
+    _M_scope_index.insert(key, scope);
+}
+
 void Binder::updateItemPosition(CodeModelItem item, AST *node)
 {
     QString filename;
@@ -31,13 +31,14 @@
 #include "type_compiler.h"
 #include "name_compiler.h"
 #include "declarator_compiler.h"
+#include "parser.h"
 
 class TokenStream;
 class LocationManager;
 class Control;
 struct NameSymbol;
 
-class Binder: protected DefaultVisitor
+class Binder: protected DefaultVisitor, public DeclarationConsumer
 {
 public:
     Binder(CodeModel *__model, LocationManager &__location, Control *__control = 0);
@@ -57,9 +58,31 @@ public:
 
     FileModelItem run(AST *node);
 
+    /**
+    *   Binds the top-level declarations one at a time while they are
+    *   parsed, see Parser::setDeclarationConsumer(). finish() returns the
+    *   file of the declarations bound since the last call, as run() does.
+    */
+    virtual void declaration(DeclarationAST *node);
+    FileModelItem finish();
+
 // utils
     TypeInfo qualifyType(const TypeInfo &type, const QStringList &context) const;
 
+    /**
+    *   The scopes qualifyType() and visitNamespace() looked up in the index
+    *   of classes and namespaces, and those it found by walking the model
+    *   from the file with CodeModel::findItem().
+    */
+    std::size_t indexedScopeLookups() const
+    {
+        return _M_indexed_lookups;
+    }
+    std::size_t scopeWalks() const
+    {
+        return _M_scope_walks;
+    }
+
 protected:
     virtual void visitAccessSpecifier(AccessSpecifierAST *);
     virtual void visitClassSpecifier(ClassSpecifierAST *);
@@ -98,6 +121,10 @@ private:
 
     void updateItemPosition(CodeModelItem item, AST *node);
 
+    CodeModelItem findScope(const QStringList &qualifiedName) const;
+    void indexScope(const QStringList &qualifiedName, CodeModelItem item, const QStringList &namespaces);
+    void startFile();
+
 private:
     CodeModel *_M_model;
     LocationManager &_M_location;
@@ -116,6 +143,18 @@ private:
     QHash<QString, QString> _M_qualified_types;
     QHash<QString, int> _M_anonymous_enums;
 
+    // The classes and namespaces that CodeModel::findItem() finds from the
+    // file, by their qualified names joined with ".". A namespace is added
+    // to its scope when its first block ends, so what it holds is found
+    // only when the enclosing namespaces are indexed.
+    struct IndexedScope {
+        CodeModelItem item;
+        QStringList namespaces;
+    };
+    QHash<QString, IndexedScope> _M_scope_index;
+    mutable std::size_t _M_indexed_lookups;
+    mutable std::size_t _M_scope_walks;
+
 protected:
     TypeCompiler type_cc;
     NameCompiler name_cc;
@@ -25,20 +25,31 @@
 
 #include "codemodel.h"
 #include <algorithm>
+#include <new>
 
 // ---------------------------------------------------------------------------
 CodeModel::CodeModel()
-        : _M_creation_id(0)
+        : _M_global_scope(new QualifiedName(0, QString())),
+        _M_creation_id(0)
 {
     _M_globalNamespace = create<NamespaceModelItem>();
 }
 
 CodeModel::~CodeModel()
 {
+    for (int i = _M_items.size() - 1; i >= 0; --i)
+        _M_items.at(i)->~_CodeModelItem();
+}
+
+void *CodeModel::allocateItem(std::size_t size)
+{
+    return _M_item_pool.allocate(size, sizeof(void *));
 }
 
 void CodeModel::wipeout()
 {
+    _M_names.clear();
+    _M_qualified_names.clear();
     _M_globalNamespace = create<NamespaceModelItem>();
     _M_files.clear();
 }
@@ -77,6 +88,43 @@ QHash<QString, FileModelItem> CodeModel::fileMap() const
     return _M_files;
 }
 
+QString CodeModel::internName(const QString &name)
+{
+    QSet<QString>::const_iterator it = _M_names.constFind(name);
+    if (it != _M_names.constEnd())
+        return *it;
+
+    _M_names.insert(name);
+    return name;
+}
+
+const QualifiedName *CodeModel::globalScope() const
+{
+    return _M_global_scope.constData();
+}
+
+const QualifiedName *CodeModel::qualifiedName(const QualifiedName *scope, const QString &name)
+{
+    QHash<QPair<const QualifiedName *, QString>, QualifiedNamePointer>::const_iterator it
+        = _M_qualified_names.constFind(qMakePair(scope, name));
+    if (it != _M_qualified_names.constEnd())
+        return it.value().constData();
+
+    // the key holds the interned string too, not the one looked up
+    QString interned = internName(name);
+    QualifiedName *qualified = new QualifiedName(scope, interned);
+    _M_qualified_names.insert(qMakePair(scope, interned), QualifiedNamePointer(qualified));
+    return qualified;
+}
+
+const QualifiedName *CodeModel::qualifiedName(const QStringList &names)
+{
+    const QualifiedName *qualified = globalScope();
+    foreach (const QString &name, names)
+        qualified = qualifiedName(qualified, name);
+    return qualified;
+}
+
 CodeModelItem CodeModel::findItem(const QStringList &qualifiedName, CodeModelItem scope) const
 {
     for (int i = 0; i < qualifiedName.size(); ++i) {
@@ -111,6 +159,15 @@ CodeModelItem CodeModel::findItem(const QStringList &qualifiedName, CodeModelIte
 }
 
 
+// ---------------------------------------------------------------------------
+QualifiedName::QualifiedName(const QualifiedName *scope, const QString &name)
+        : _M_scope(scope),
+        _M_name(name)
+{
+    if (scope)
+        _M_names = scope->names() << name;
+}
+
 // ---------------------------------------------------------------------------
 TypeInfo TypeInfo::combine(const TypeInfo &__lhs, const TypeInfo &__rhs)
 {
@@ -213,7 +270,8 @@ _CodeModelItem::_CodeModelItem(CodeModel *model, int kind)
         _M_startColumn(0),
         _M_endLine(0),
         _M_endColumn(0),
-        _M_creation_id(0)
+        _M_creation_id(0),
+        _M_qualifiedName(model->qualifiedName(model->globalScope(), QString()))
 {
 }
 
@@ -238,32 +296,46 @@ void _CodeModelItem::setKind(int kind)
 
 QStringList _CodeModelItem::qualifiedName() const
 {
-    QStringList q = scope();
-
-    if (!name().isEmpty())
-        q += name();
-
-    return q;
+    return internedQualifiedName()->names();
 }
 
 QString _CodeModelItem::name() const
 {
-    return _M_name;
+    return _M_qualifiedName->name();
 }
 
 void _CodeModelItem::setName(const QString &name)
 {
-    _M_name = name;
+    _M_qualifiedName = _M_model->qualifiedName(_M_qualifiedName->scope(), name);
 }
 
 QStringList _CodeModelItem::scope() const
 {
-    return _M_scope;
+    return _M_qualifiedName->scope()->names();
 }
 
 void _CodeModelItem::setScope(const QStringList &scope)
 {
-    _M_scope = scope;
+    setScope(_M_model->qualifiedName(scope));
+}
+
+const QualifiedName *_CodeModelItem::internedQualifiedName() const
+{
+    if (_M_qualifiedName->name().isEmpty())
+        return _M_qualifiedName->scope();
+
+    return _M_qualifiedName.constData();
+}
+
+const QualifiedName *_CodeModelItem::internedScope() const
+{
+    return _M_qualifiedName->scope();
+}
+
+void _CodeModelItem::setScope(const QualifiedName *scope)
+{
+    if (scope != _M_qualifiedName->scope())
+        _M_qualifiedName = _M_model->qualifiedName(scope, name());
 }
 
 QString _CodeModelItem::fileName() const
@@ -273,7 +345,7 @@ QString _CodeModelItem::fileName() const
 
 void _CodeModelItem::setFileName(const QString &fileName)
 {
-    _M_fileName = fileName;
+    _M_fileName = _M_model->internName(fileName);
 }
 
 FileModelItem _CodeModelItem::file() const
@@ -772,73 +844,73 @@ void _TemplateParameterModelItem::setDefaultValue(bool defaultValue)
 // ---------------------------------------------------------------------------
 ScopeModelItem _ScopeModelItem::create(CodeModel *model)
 {
-    ScopeModelItem item(new _ScopeModelItem(model));
+    ScopeModelItem item(new (model->allocateItem(sizeof(_ScopeModelItem))) _ScopeModelItem(model));
     return item;
 }
 
 ClassModelItem _ClassModelItem::create(CodeModel *model)
 {
-    ClassModelItem item(new _ClassModelItem(model));
+    ClassModelItem item(new (model->allocateItem(sizeof(_ClassModelItem))) _ClassModelItem(model));
     return item;
 }
 
 NamespaceModelItem _NamespaceModelItem::create(CodeModel *model)
 {
-    NamespaceModelItem item(new _NamespaceModelItem(model));
+    NamespaceModelItem item(new (model->allocateItem(sizeof(_NamespaceModelItem))) _NamespaceModelItem(model));
     return item;
 }
 
 FileModelItem _FileModelItem::create(CodeModel *model)
 {
-    FileModelItem item(new _FileModelItem(model));
+    FileModelItem item(new (model->allocateItem(sizeof(_FileModelItem))) _FileModelItem(model));
     return item;
 }
 
 ArgumentModelItem _ArgumentModelItem::create(CodeModel *model)
 {
-    ArgumentModelItem item(new _ArgumentModelItem(model));
+    ArgumentModelItem item(new (model->allocateItem(sizeof(_ArgumentModelItem))) _ArgumentModelItem(model));
     return item;
 }
 
 FunctionModelItem _FunctionModelItem::create(CodeModel *model)
 {
-    FunctionModelItem item(new _FunctionModelItem(model));
+    FunctionModelItem item(new (model->allocateItem(sizeof(_FunctionModelItem))) _FunctionModelItem(model));
     return item;
 }
 
 FunctionDefinitionModelItem _FunctionDefinitionModelItem::create(CodeModel *model)
 {
-    FunctionDefinitionModelItem item(new _FunctionDefinitionModelItem(model));
+    FunctionDefinitionModelItem item(new (model->allocateItem(sizeof(_FunctionDefinitionModelItem))) _FunctionDefinitionModelItem(model));
     return item;
 }
 
 VariableModelItem _VariableModelItem::create(CodeModel *model)
 {
-    VariableModelItem item(new _VariableModelItem(model));
+    VariableModelItem item(new (model->allocateItem(sizeof(_VariableModelItem))) _VariableModelItem(model));
     return item;
 }
 
 TypeAliasModelItem _TypeAliasModelItem::create(CodeModel *model)
 {
-    TypeAliasModelItem item(new _TypeAliasModelItem(model));
+    TypeAliasModelItem item(new (model->allocateItem(sizeof(_TypeAliasModelItem))) _TypeAliasModelItem(model));
     return item;
 }
 
 EnumModelItem _EnumModelItem::create(CodeModel *model)
 {
-    EnumModelItem item(new _EnumModelItem(model));
+    EnumModelItem item(new (model->allocateItem(sizeof(_EnumModelItem))) _EnumModelItem(model));
     return item;
 }
 
 EnumeratorModelItem _EnumeratorModelItem::create(CodeModel *model)
 {
-    EnumeratorModelItem item(new _EnumeratorModelItem(model));
+    EnumeratorModelItem item(new (model->allocateItem(sizeof(_EnumeratorModelItem))) _EnumeratorModelItem(model));
     return item;
 }
 
 TemplateParameterModelItem _TemplateParameterModelItem::create(CodeModel *model)
 {
-    TemplateParameterModelItem item(new _TemplateParameterModelItem(model));
+    TemplateParameterModelItem item(new (model->allocateItem(sizeof(_TemplateParameterModelItem))) _TemplateParameterModelItem(model));
     return item;
 }
 
@@ -28,9 +28,13 @@
 
 #include "codemodel_fwd.h"
 #include "codemodel_pointer.h"
+#include "smallobject.h"
 
 #include <QtCore/QHash>
 #include <QtCore/QList>
+#include <QtCore/QPair>
+#include <QtCore/QSet>
+#include <QtCore/QSharedData>
 #include <QtCore/QString>
 #include <QtCore/QStringList>
 #include <QtCore/QVector>
@@ -48,6 +52,43 @@ _Target model_static_cast(_Source item)
     return ptr;
 }
 
+/**
+*   A qualified name interned by a CodeModel: equal names in equal scopes
+*   share one QualifiedName, so that qualified names compare by pointer.
+*   It holds on to its scope, and keeps the names of the whole chain so
+*   that they are not put together again each time they are asked for.
+*/
+class QualifiedName: public QSharedData
+{
+public:
+    // the enclosing scope, 0 for the global scope
+    inline const QualifiedName *scope() const
+    {
+        return _M_scope.constData();
+    }
+
+    inline QString name() const
+    {
+        return _M_name;
+    }
+
+    inline QStringList names() const
+    {
+        return _M_names;
+    }
+
+private:
+    QualifiedName(const QualifiedName *scope, const QString &name);
+
+    QExplicitlySharedDataPointer<const QualifiedName> _M_scope;
+    QString _M_name;
+    QStringList _M_names;
+
+    friend class CodeModel;
+};
+
+typedef QExplicitlySharedDataPointer<const QualifiedName> QualifiedNamePointer;
+
 class CodeModel
 {
 public:
@@ -79,9 +120,28 @@ public:
 
         _Target result = _Target_type::create(this);
         result->setCreationId(_M_creation_id++);
+        _M_items.append(result.data());
         return result;
     }
 
+    /**
+    *   The items are carved out of a pool of the model, and destroyed all
+    *   at once with it. Their handles are plain pointers, which stay valid
+    *   for as long as the model lives: it must outlive its items.
+    */
+    void *allocateItem(std::size_t size);
+
+    // the items made, and the bytes of the pool they take
+    inline int itemCount() const
+    {
+        return _M_items.size();
+    }
+
+    inline std::size_t itemMemory() const
+    {
+        return _M_item_pool.used();
+    }
+
     FileList files() const;
     NamespaceModelItem globalNamespace() const;
 
@@ -92,9 +152,25 @@ public:
 
     CodeModelItem findItem(const QStringList &qualifiedName, CodeModelItem scope) const;
 
+    /**
+    *   The names, scopes and file names of the items are interned here:
+    *   equal names share one string, however many items have them, and
+    *   equal qualified names one QualifiedName. Both outlive the model
+    *   for as long as items use them.
+    */
+    QString internName(const QString &name);
+    const QualifiedName *globalScope() const;
+    const QualifiedName *qualifiedName(const QualifiedName *scope, const QString &name);
+    const QualifiedName *qualifiedName(const QStringList &names);
+
     void wipeout();
 
 private:
+    pool _M_item_pool;
+    QVector<_CodeModelItem *> _M_items;
+    QSet<QString> _M_names;
+    QHash<QPair<const QualifiedName *, QString>, QualifiedNamePointer> _M_qualified_names;
+    QualifiedNamePointer _M_global_scope;
     QHash<QString, FileModelItem> _M_files;
     NamespaceModelItem _M_globalNamespace;
     std::size_t _M_creation_id;
@@ -230,7 +306,7 @@ private:
     QList<TypeInfo> m_arguments;
 };
 
-class _CodeModelItem: public QSharedData
+class _CodeModelItem
 {
 public:
     enum Kind {
@@ -267,6 +343,17 @@ public:
     QStringList scope() const;
     void setScope(const QStringList &scope);
 
+    /**
+    *   The interned qualified name and scope, which are the same for items
+    *   of the model that have the same qualifiedName() or scope(). An item
+    *   without a name goes by the name of its scope.
+    */
+    const QualifiedName *internedQualifiedName() const;
+    const QualifiedName *internedScope() const;
+
+    // \a scope must be interned by the model of the item
+    void setScope(const QualifiedName *scope);
+
     QString fileName() const;
     void setFileName(const QString &fileName);
 
@@ -307,9 +394,8 @@ private:
     int _M_endLine;
     int _M_endColumn;
     std::size_t _M_creation_id;
-    QString _M_name;
+    QualifiedNamePointer _M_qualifiedName;
     QString _M_fileName;
-    QStringList _M_scope;
 
 private:
     _CodeModelItem(const _CodeModelItem &other);
@@ -25,36 +25,66 @@
 #ifndef CODEMODEL_POINTER_H
 #define CODEMODEL_POINTER_H
 
-#include <QtCore/QSharedData>
-#include <QAtomicPointer>
-
-template <class T> class CodeModelPointer : public QAtomicPointer<T>
+/**
+*   A handle on an item of a CodeModel. The items belong to their model,
+*   which destroys them all at once, so a handle is a plain pointer: it is
+*   neither reference counted nor accessed atomically.
+*/
+template <class T> class CodeModelPointer
 {
 public:
     typedef T Type;
 
-    inline CodeModelPointer(T *value = 0) : QAtomicPointer<T>(value) {}
+    inline CodeModelPointer(T *value = 0) : _M_value(value) {}
 
     inline CodeModelPointer &operator=(T *o)
     {
-        QAtomicPointer<T>::operator=(o);
+        _M_value = o;
         return *this;
     }
 
     inline T *data()
     {
-        return (T *) *this;
+        return _M_value;
     }
 
     inline const T *data() const
     {
-        return (const T *) *this;
+        return _M_value;
     }
 
     inline const T *constData() const
     {
-        return (const T *) *this;
+        return _M_value;
     }
+
+    inline operator T *() const
+    {
+        return _M_value;
+    }
+
+    inline T *operator->() const
+    {
+        return _M_value;
+    }
+
+    inline bool operator!() const
+    {
+        return !_M_value;
+    }
+
+    inline bool operator==(T *o) const
+    {
+        return _M_value == o;
+    }
+
+    inline bool operator!=(T *o) const
+    {
+        return _M_value != o;
+    }
+
+private:
+    T *_M_value;
 };
 
 #endif // CODEMODEL_POINTER_H
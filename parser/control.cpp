@@ -26,8 +26,9 @@
 #include "control.h"
 #include "lexer.h"
 
-Control::Control()
+Control::Control(NameTable *names)
         : current_context(0),
+        name_table(names ? names : &_M_names),
         _M_skipFunctionBody(false),
         _M_lexer(0),
         _M_parser(0)
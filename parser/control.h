@@ -102,7 +102,13 @@ public:
         QString _M_message;
     };
 
-    Control();
+    /**
+    *   Names are interned in \a names when given, a NameTable the control
+    *   doesn't own, shared with other controls, and in a table of its own
+    *   otherwise. The table isn't thread-safe: of the controls sharing it,
+    *   only one may intern names while the others are in use.
+    */
+    explicit Control(NameTable *names = 0);
     ~Control();
 
     inline bool skipFunctionBody() const {
@@ -135,7 +141,11 @@ public:
     void declare(const NameSymbol *name, Type *type);
 
     inline const NameSymbol *findOrInsertName(const char *data, size_t count) {
-        return name_table.findOrInsert(data, count);
+        return name_table->findOrInsert(data, count);
+    }
+
+    inline NameTable *nameTable() const {
+        return name_table;
     }
 
     void declareTypedef(const NameSymbol *name, Declarator *d);
@@ -146,7 +156,8 @@ public:
     void clearErrorMessages();
 
 private:
-    NameTable name_table;
+    NameTable _M_names;
+    NameTable *name_table;
     QHash<const NameSymbol*, Declarator*> stl_typedef_table;
     bool _M_skipFunctionBody;
     Lexer *_M_lexer;
@@ -0,0 +1,227 @@
+/*
+ * This file is part of the API Extractor project.
+ *
+ * Copyright (C) 2009 Nokia Corporation and/or its subsidiary(-ies).
+ *
+ * Contact: PySide team <contact@pyside.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+
+/*
+ * Writes lexer_keywords.h, the keyword recogniser used by the Lexer.
+ *
+ * The keywords are the names of the token kinds in tokens.cpp, less the
+ * ones naming punctuators and literals. Each keyword is reduced to its
+ * length, first, second and last characters, which are enough to tell
+ * the keywords apart, and these are mapped to a table holding exactly
+ * one slot per keyword using a hash-and-displace minimal perfect hash:
+ * a first hash picks a bucket, and each bucket has a seed chosen so that
+ * a second hash sends its keywords to free slots. An identifier is then
+ * a keyword if it matches the text of the slot it hashes to.
+ */
+
+#include "tokens.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// token kinds that are not spelled as identifiers, or that the lexer
+// leaves to the parser as plain identifiers
+static char const * const non_keywords[] = {
+    "arrow", "assign", "char_literal", "comment", "concat", "decr",
+    "ellipsis", "eq", "false", "geq", "identifier", "incr", "leq",
+    "number_literal", "preproc", "ptrmem", "scope", "shift",
+    "string_literal", "true", "wchar_t", "whitespaces"
+};
+
+// must match keyword_key() and keyword_hash() in the generated header
+static unsigned keyword_key(const std::string &text)
+{
+    return unsigned(text.size()) << 24
+           | unsigned((unsigned char) text[text.size() - 1]) << 16
+           | unsigned((unsigned char) text[1]) << 8
+           | unsigned((unsigned char) text[0]);
+}
+
+static unsigned keyword_hash(unsigned key, unsigned seed)
+{
+    key = (key ^ seed) * 0x9e3779b1u;
+    return key ^ (key >> 15);
+}
+
+struct Keyword {
+    std::string text;
+    int kind;
+    unsigned key;
+};
+
+struct Bucket {
+    std::vector<int> keywords;
+    unsigned seed;
+    int index;
+};
+
+static bool larger(const Bucket &a, const Bucket &b)
+{
+    return a.keywords.size() > b.keywords.size();
+}
+
+static bool byIndex(const Bucket &a, const Bucket &b)
+{
+    return a.index < b.index;
+}
+
+static bool isKeyword(const char *name)
+{
+    for (std::size_t i = 0; i < sizeof(non_keywords) / sizeof(non_keywords[0]); ++i) {
+        if (!std::strcmp(name, non_keywords[i]))
+            return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 2) {
+        std::fprintf(stderr, "usage: %s <lexer_keywords.h>\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<Keyword> keywords;
+    std::size_t maxSize = 0;
+    for (int kind = Token_K_DCOP; kind < TOKEN_KIND_COUNT; ++kind) {
+        const char *name = token_name(kind);
+        if (!isKeyword(name))
+            continue;
+
+        Keyword keyword;
+        keyword.text = name;
+        keyword.kind = kind;
+        if (keyword.text.size() < 2) {
+            std::fprintf(stderr, "keyword too short: %s\n", name);
+            return 1;
+        }
+        keyword.key = keyword_key(keyword.text);
+        for (std::size_t i = 0; i < keywords.size(); ++i) {
+            if (keywords[i].key == keyword.key) {
+                std::fprintf(stderr, "keywords %s and %s can't be told apart\n",
+                             keywords[i].text.c_str(), name);
+                return 1;
+            }
+        }
+        keywords.push_back(keyword);
+        maxSize = std::max(maxSize, keyword.text.size());
+    }
+
+    const int count = int(keywords.size());
+    const int bucketCount = (count + 1) / 2;
+
+    std::vector<Bucket> buckets(bucketCount);
+    for (int i = 0; i < bucketCount; ++i) {
+        buckets[i].seed = 0;
+        buckets[i].index = i;
+    }
+    for (int i = 0; i < count; ++i)
+        buckets[keyword_hash(keywords[i].key, 0) % bucketCount].keywords.push_back(i);
+
+    // place the crowded buckets first, while there is still room
+    std::stable_sort(buckets.begin(), buckets.end(), larger);
+
+    std::vector<int> slots(count, -1);
+    for (int b = 0; b < bucketCount && !buckets[b].keywords.empty(); ++b) {
+        Bucket &bucket = buckets[b];
+        std::vector<int> taken;
+        for (unsigned seed = 1; ; ++seed) {
+            if (seed == 0x1000000) {
+                std::fprintf(stderr, "no perfect hash found\n");
+                return 1;
+            }
+
+            taken.clear();
+            for (std::size_t k = 0; k < bucket.keywords.size(); ++k) {
+                int slot = keyword_hash(keywords[bucket.keywords[k]].key, seed) % count;
+                if (slots[slot] != -1 || std::find(taken.begin(), taken.end(), slot) != taken.end())
+                    break;
+                taken.push_back(slot);
+            }
+
+            if (taken.size() == bucket.keywords.size()) {
+                for (std::size_t k = 0; k < taken.size(); ++k)
+                    slots[taken[k]] = bucket.keywords[k];
+                bucket.seed = seed;
+                break;
+            }
+        }
+    }
+
+    std::sort(buckets.begin(), buckets.end(), byIndex);
+
+    FILE *out = std::fopen(argv[1], "w");
+    if (!out) {
+        std::fprintf(stderr, "can't write %s\n", argv[1]);
+        return 1;
+    }
+
+    std::fprintf(out, "// Generated by generate_keywords from tokens.cpp, do not edit.\n\n");
+    std::fprintf(out, "#ifndef LEXER_KEYWORDS_H\n#define LEXER_KEYWORDS_H\n\n");
+    std::fprintf(out, "#include \"tokens.h\"\n\n#include <cstring>\n\n");
+    std::fprintf(out, "struct LexerKeyword {\n    const char *text;\n    int size;\n    int kind;\n};\n\n");
+
+    std::fprintf(out, "static const unsigned lexer_keyword_seeds[%d] = {", bucketCount);
+    for (int i = 0; i < bucketCount; ++i)
+        std::fprintf(out, "%s%u", i % 8 ? ", " : (i ? ",\n    " : "\n    "), buckets[i].seed);
+    std::fprintf(out, "\n};\n\n");
+
+    std::fprintf(out, "static const LexerKeyword lexer_keywords[%d] = {\n", count);
+    for (int i = 0; i < count; ++i) {
+        const Keyword &keyword = keywords[slots[i]];
+        std::fprintf(out, "    { \"%s\", %d, Token_%s }%s\n", keyword.text.c_str(),
+                     int(keyword.text.size()), keyword.text.c_str(), i + 1 < count ? "," : "");
+    }
+    std::fprintf(out, "};\n\n");
+
+    std::fprintf(out,
+                 "static inline unsigned keyword_hash(unsigned key, unsigned seed)\n"
+                 "{\n"
+                 "    key = (key ^ seed) * 0x9e3779b1u;\n"
+                 "    return key ^ (key >> 15);\n"
+                 "}\n\n");
+
+    std::fprintf(out,
+                 "// the kind of the token spelled by text, Token_identifier if it isn't a keyword\n"
+                 "static inline int keyword_kind(const unsigned char *text, int size)\n"
+                 "{\n"
+                 "    if (size < 2 || size > %d)\n"
+                 "        return Token_identifier;\n\n"
+                 "    unsigned key = unsigned(size) << 24 | unsigned(text[size - 1]) << 16\n"
+                 "                   | unsigned(text[1]) << 8 | unsigned(text[0]);\n"
+                 "    unsigned seed = lexer_keyword_seeds[keyword_hash(key, 0) %% %d];\n"
+                 "    const LexerKeyword &keyword = lexer_keywords[keyword_hash(key, seed) %% %d];\n"
+                 "    if (keyword.size != size || std::memcmp(keyword.text, text, size))\n"
+                 "        return Token_identifier;\n\n"
+                 "    return keyword.kind;\n"
+                 "}\n\n", int(maxSize), bucketCount, count);
+
+    std::fprintf(out, "#endif\n");
+
+    return std::fclose(out) ? 1 : 0;
+}
+
+// kate: space-indent on; indent-width 2; replace-tabs on;
@@ -26,40 +26,26 @@
 #include "lexer.h"
 #include "tokens.h"
 #include "control.h"
+#include "lexer_keywords.h"
 
+#include <algorithm>
 #include <cctype>
 #include <iostream>
 
-scan_fun_ptr Lexer::s_scan_keyword_table[] = {
-    &Lexer::scanKeyword0, &Lexer::scanKeyword0,
-    &Lexer::scanKeyword2, &Lexer::scanKeyword3,
-    &Lexer::scanKeyword4, &Lexer::scanKeyword5,
-    &Lexer::scanKeyword6, &Lexer::scanKeyword7,
-    &Lexer::scanKeyword8, &Lexer::scanKeyword9,
-    &Lexer::scanKeyword10, &Lexer::scanKeyword11,
-    &Lexer::scanKeyword12, &Lexer::scanKeyword13,
-    &Lexer::scanKeyword14, &Lexer::scanKeyword0,
-    &Lexer::scanKeyword16
-};
-
-void LocationManager::extract_line(int offset, int *line, QString *filename) const
+void LocationManager::addLineMarker(const unsigned char *marker, std::size_t ppline)
 {
-    *line = 0;
-    if (token_stream.size() < 1)
-        return;
-
-    const unsigned char *begin_buffer = reinterpret_cast<const unsigned char *>(token_stream[0].text);
-    const unsigned char *cursor = begin_buffer + offset;
+    LineMarker lineMarker;
+    lineMarker.line = 0;
+    lineMarker.file = -1;
+    lineMarker.ppline = (int) ppline;
 
-    ++cursor; // skip '#'
+    const unsigned char *cursor = marker + 1; // skip '#'
     if (std::isspace(*cursor) && std::isdigit(*(cursor + 1))) {
         ++cursor;
-        char buffer[1024], *cp = buffer;
+        int l = 0;
         do {
-            *cp++ = *cursor++;
+            l = l * 10 + (*cursor++ - '0');
         } while (std::isdigit(*cursor));
-        *cp = '\0';
-        int l = strtol(buffer, 0, 0);
 
         Q_ASSERT(std::isspace(*cursor));
         ++cursor;
@@ -67,18 +53,38 @@ void LocationManager::extract_line(int offset, int *line, QString *filename) con
         Q_ASSERT(*cursor == '"');
         ++cursor;
 
-        cp = buffer;
-        while (*cursor && *cursor != '"') {
-            *cp++ = *cursor++;
-        }
-        *cp = '\0';
+        const unsigned char *begin = cursor;
+        while (*cursor && *cursor != '"' && *cursor != '\n')
+            ++cursor;
         Q_ASSERT(*cursor == '"');
-        ++cursor;
 
-        *filename = buffer;
-        *line = l;
-        // printf("filename: %s line: %d\n", buffer, line);
+        QString fileName = QString::fromAscii((const char *) begin, int(cursor - begin));
+        QHash<QString, int>::const_iterator it = file_index.constFind(fileName);
+        if (it == file_index.constEnd()) {
+            lineMarker.file = file_names.size();
+            file_index.insert(fileName, lineMarker.file);
+            file_names.append(fileName);
+        } else {
+            lineMarker.file = it.value();
+        }
+        lineMarker.line = l;
     }
+
+    line_markers.push_back(lineMarker);
+}
+
+void LocationManager::clearLineMarkers()
+{
+    // the start of the text, before any marker
+    LineMarker start;
+    start.line = 0;
+    start.file = -1;
+    start.ppline = 1;
+
+    line_markers.clear();
+    line_markers.push_back(start);
+    file_names.clear();
+    file_index.clear();
 }
 
 void LocationManager::positionAt(std::size_t offset, int *line, int *column,
@@ -87,33 +93,89 @@ void LocationManager::positionAt(std::size_t offset, int *line, int *column,
     int ppline, ppcolumn;
     line_table.positionAt(offset, &ppline, &ppcolumn);
 
-    int base_line;
-    extract_line((int) line_table[ppline-1], &base_line, filename);
-
-    int line2, column2;
-    location_table.positionAt((int) line_table[ppline-1], &line2, &column2);
+    const LineMarker &marker = line_markers[ppline - 1];
+    if (marker.file >= 0)
+        *filename = file_names.at(marker.file);
 
     location_table.positionAt(offset, line, column);
-    *line = base_line + *line - line2  - 1;
+    *line = marker.line + *line - marker.ppline - 1;
 }
 
 scan_fun_ptr Lexer::s_scan_table[256];
 bool Lexer::s_initialized = false;
 
 void Lexer::tokenize(const char *contents, std::size_t size)
+{
+    if (!streaming)
+        start(contents, size);
+
+    scan(contents, size);
+
+    if (index == token_stream.size())
+        token_stream.resize(token_stream.size() * 2);
+
+    Q_ASSERT(index < token_stream.size());
+    token_stream.positions[index] = cursor - begin_buffer;
+    token_stream.kinds[index] = Token_EOF;
+    token_stream.end_index = index;
+
+    if (streaming) {
+        // names were not interned while the text could still move
+        for (std::size_t i = 0; i < index; ++i) {
+            std::size_t position = token_stream.positions[i];
+            std::size_t size;
+            switch (token_stream.kinds[i]) {
+            case Token_char_literal:
+            case Token_string_literal:
+                size = token_stream.tokenSize(i);
+                if (contents[position] == 'L') {
+                    ++position;
+                    --size;
+                }
+                token_stream.extras[i].symbol = control->findOrInsertName(contents + position, size);
+                break;
+            case Token_identifier:
+            case Token_number_literal:
+                size = token_stream.tokenSize(i);
+                token_stream.extras[i].symbol = control->findOrInsertName(contents + position, size);
+                break;
+            default:
+                break;
+            }
+        }
+        streaming = false;
+    }
+}
+
+void Lexer::feed(const char *contents, std::size_t size)
+{
+    if (!streaming) {
+        start(contents, 0);
+        streaming = true;
+    }
+
+    // tokens never span a newline, a line is lexed once it is complete
+    while (size > lexed && contents[size - 1] != '\n')
+        --size;
+
+    if (size > lexed)
+        scan(contents, size);
+}
+
+void Lexer::start(const char *contents, std::size_t size)
 {
     if (!s_initialized)
         initialize_scan_table();
 
-    token_stream.resize(1024);
-    token_stream[0].kind = Token_EOF;
-    token_stream[0].text = contents;
+    // preprocessed code has about one token every five or six bytes
+    token_stream.resize(std::max(std::size_t(1024), size / 4));
+    token_stream.text = contents;
+    token_stream.kinds[0] = Token_EOF;
+    token_stream.positions[0] = 0;
 
     index = 1;
-
-    cursor = (const unsigned char *) contents;
-    begin_buffer = (const unsigned char *) contents;
-    end_buffer = cursor + size;
+    lexed = 0;
+    open_braces.clear();
 
     location_table.resize(1024);
     location_table[0] = 0;
@@ -122,24 +184,32 @@ void Lexer::tokenize(const char *contents, std::size_t size)
     line_table.resize(1024);
     line_table[0] = 0;
     line_table.current_line = 1;
+    _M_location.clearLineMarkers();
+}
+
+void Lexer::scan(const char *contents, std::size_t size)
+{
+    token_stream.text = contents;
+
+    begin_buffer = (const unsigned char *) contents;
+    cursor = begin_buffer + lexed;
+    end_buffer = begin_buffer + size;
 
-    do {
+    while (cursor < end_buffer) {
         if (index == token_stream.size())
             token_stream.resize(token_stream.size() * 2);
 
-        Token *current_token = &token_stream[(int) index];
-        current_token->text = reinterpret_cast<const char*>(begin_buffer);
-        current_token->position = cursor - begin_buffer;
+        token_stream.positions[index] = cursor - begin_buffer;
         (this->*s_scan_table[*cursor])();
-        current_token->size = cursor - begin_buffer - current_token->position;
-    } while (cursor < end_buffer);
+    }
 
-    if (index == token_stream.size())
-        token_stream.resize(token_stream.size() * 2);
+    lexed = cursor - begin_buffer;
+}
 
-    Q_ASSERT(index < token_stream.size());
-    token_stream[(int) index].position = cursor - begin_buffer;
-    token_stream[(int) index].kind = Token_EOF;
+const NameSymbol *Lexer::nameSymbol(const unsigned char *begin, std::size_t size)
+{
+    // fed text may still move, tokenize() interns the names once it is complete
+    return streaming ? 0 : control->findOrInsertName((const char*) begin, size);
 }
 
 void Lexer::reportError(const QString& msg)
@@ -216,6 +286,7 @@ void Lexer::scan_preprocessor()
         line_table.resize(line_table.current_line * 2);
 
     line_table[(int) line_table.current_line++] = (cursor - begin_buffer);
+    _M_location.addLineMarker(cursor, location_table.current_line);
 
     while (*cursor && *cursor != '\n')
         ++cursor;
@@ -243,10 +314,9 @@ void Lexer::scan_char_constant()
 
     ++cursor;
 
-    token_stream[(int) index].extra.symbol =
-        control->findOrInsertName((const char*) begin, cursor - begin);
+    token_stream.extras[index].symbol = nameSymbol(begin, cursor - begin);
 
-    token_stream[(int) index++].kind = Token_char_literal;
+    token_stream.kinds[index++] = Token_char_literal;
 }
 
 void Lexer::scan_string_constant()
@@ -268,10 +338,9 @@ void Lexer::scan_string_constant()
 
     ++cursor;
 
-    token_stream[(int) index].extra.symbol =
-        control->findOrInsertName((const char*) begin, cursor - begin);
+    token_stream.extras[index].symbol = nameSymbol(begin, cursor - begin);
 
-    token_stream[(int) index++].kind = Token_string_literal;
+    token_stream.kinds[index++] = Token_string_literal;
 }
 
 void Lexer::scan_newline()
@@ -319,13 +388,10 @@ void Lexer::scan_identifier_or_keyword()
         ++skip;
 
     int n = skip - cursor;
-    Token *current_token = &token_stream[(int) index];
-    (this->*s_scan_keyword_table[n < 17 ? n : 0])();
-
-    if (current_token->kind == Token_identifier) {
-        current_token->extra.symbol =
-            control->findOrInsertName((const char*) cursor, n);
-    }
+    int kind = keyword_kind(cursor, n);
+    if (kind == Token_identifier)
+        token_stream.extras[index].symbol = nameSymbol(cursor, n);
+    token_stream.kinds[index++] = kind;
 
     cursor = skip;
 }
@@ -342,10 +408,9 @@ void Lexer::scan_int_constant()
     while (isalnum(*cursor) || *cursor == '.')
         ++cursor;
 
-    token_stream[(int) index].extra.symbol =
-        control->findOrInsertName((const char*) begin, cursor - begin);
+    token_stream.extras[index].symbol = nameSymbol(begin, cursor - begin);
 
-    token_stream[(int) index++].kind = Token_number_literal;
+    token_stream.kinds[index++] = Token_number_literal;
 }
 
 void Lexer::scan_not()
@@ -359,9 +424,9 @@ void Lexer::scan_not()
 
     if (*cursor == '=') {
         ++cursor;
-        token_stream[(int) index++].kind = Token_not_eq;
+        token_stream.kinds[index++] = Token_not_eq;
     } else {
-        token_stream[(int) index++].kind = '!';
+        token_stream.kinds[index++] = '!';
     }
 }
 
@@ -376,9 +441,9 @@ void Lexer::scan_remainder()
 
     if (*cursor == '=') {
         ++cursor;
-        token_stream[(int) index++].kind = Token_assign;
+        token_stream.kinds[index++] = Token_assign;
     } else {
-        token_stream[(int) index++].kind = '%';
+        token_stream.kinds[index++] = '%';
     }
 }
 
@@ -393,25 +458,25 @@ void Lexer::scan_and()
     ++cursor;
     if (*cursor == '=') {
         ++cursor;
-        token_stream[(int) index++].kind = Token_assign;
+        token_stream.kinds[index++] = Token_assign;
     } else if (*cursor == '&') {
         ++cursor;
-        token_stream[(int) index++].kind = Token_and;
+        token_stream.kinds[index++] = Token_and;
     } else {
-        token_stream[(int) index++].kind = '&';
+        token_stream.kinds[index++] = '&';
     }
 }
 
 void Lexer::scan_left_paren()
 {
     ++cursor;
-    token_stream[(int) index++].kind = '(';
+    token_stream.kinds[index++] = '(';
 }
 
 void Lexer::scan_right_paren()
 {
     ++cursor;
-    token_stream[(int) index++].kind = ')';
+    token_stream.kinds[index++] = ')';
 }
 
 void Lexer::scan_star()
@@ -425,9 +490,9 @@ void Lexer::scan_star()
 
     if (*cursor == '=') {
         ++cursor;
-        token_stream[(int) index++].kind = Token_assign;
+        token_stream.kinds[index++] = Token_assign;
     } else {
-        token_stream[(int) index++].kind = '*';
+        token_stream.kinds[index++] = '*';
     }
 }
 
@@ -442,19 +507,19 @@ void Lexer::scan_plus()
     ++cursor;
     if (*cursor == '=') {
         ++cursor;
-        token_stream[(int) index++].kind = Token_assign;
+        token_stream.kinds[index++] = Token_assign;
     } else if (*cursor == '+') {
         ++cursor;
-        token_stream[(int) index++].kind = Token_incr;
+        token_stream.kinds[index++] = Token_incr;
     } else {
-        token_stream[(int) index++].kind = '+';
+        token_stream.kinds[index++] = '+';
     }
 }
 
 void Lexer::scan_comma()
 {
     ++cursor;
-    token_stream[(int) index++].kind = ',';
+    token_stream.kinds[index++] = ',';
 }
 
 void Lexer::scan_minus()
@@ -469,19 +534,23 @@ void Lexer::scan_minus()
     ++cursor;
     if (*cursor == '=') {
         ++cursor;
-        token_stream[(int) index++].kind = Token_assign;
+        token_stream.kinds[index++] = Token_assign;
     } else if (*cursor == '-') {
         ++cursor;
-        token_stream[(int) index++].kind = Token_decr;
+        token_stream.kinds[index++] = Token_decr;
     } else if (*cursor == '>') {
         ++cursor;
-        token_stream[(int) index++].kind = Token_arrow;
+        token_stream.kinds[index++] = Token_arrow;
         if (*cursor == '*') {
+            // a second token, the '*' of '->*'
+            if (index == token_stream.size())
+                token_stream.resize(token_stream.size() * 2);
+            token_stream.positions[index] = cursor - begin_buffer;
             ++cursor;
-            token_stream[(int) index++].kind = Token_ptrmem;
+            token_stream.kinds[index++] = Token_ptrmem;
         }
     } else {
-        token_stream[(int) index++].kind = '-';
+        token_stream.kinds[index++] = '-';
     }
 }
 
@@ -495,12 +564,12 @@ void Lexer::scan_dot()
     ++cursor;
     if (*cursor == '.' && *(cursor + 1) == '.') {
         cursor += 2;
-        token_stream[(int) index++].kind = Token_ellipsis;
+        token_stream.kinds[index++] = Token_ellipsis;
     } else if (*cursor == '.' && *(cursor + 1) == '*') {
         cursor += 2;
-        token_stream[(int) index++].kind = Token_ptrmem;
+        token_stream.kinds[index++] = Token_ptrmem;
     } else
-        token_stream[(int) index++].kind = '.';
+        token_stream.kinds[index++] = '.';
 }
 
 void Lexer::scan_divide()
@@ -514,9 +583,9 @@ void Lexer::scan_divide()
 
     if (*cursor == '=') {
         ++cursor;
-        token_stream[(int) index++].kind = Token_assign;
+        token_stream.kinds[index++] = Token_assign;
     } else {
-        token_stream[(int) index++].kind = '/';
+        token_stream.kinds[index++] = '/';
     }
 }
 
@@ -525,16 +594,16 @@ void Lexer::scan_colon()
     ++cursor;
     if (*cursor == ':') {
         ++cursor;
-        token_stream[(int) index++].kind = Token_scope;
+        token_stream.kinds[index++] = Token_scope;
     } else {
-        token_stream[(int) index++].kind = ':';
+        token_stream.kinds[index++] = ':';
     }
 }
 
 void Lexer::scan_semicolon()
 {
     ++cursor;
-    token_stream[(int) index++].kind = ';';
+    token_stream.kinds[index++] = ';';
 }
 
 void Lexer::scan_less()
@@ -549,17 +618,17 @@ void Lexer::scan_less()
     ++cursor;
     if (*cursor == '=') {
         ++cursor;
-        token_stream[(int) index++].kind = Token_leq;
+        token_stream.kinds[index++] = Token_leq;
     } else if (*cursor == '<') {
         ++cursor;
         if (*cursor == '=') {
             ++cursor;
-            token_stream[(int) index++].kind = Token_assign;
+            token_stream.kinds[index++] = Token_assign;
         } else {
-            token_stream[(int) index++].kind = Token_shift;
+            token_stream.kinds[index++] = Token_shift;
         }
     } else {
-        token_stream[(int) index++].kind = '<';
+        token_stream.kinds[index++] = '<';
     }
 }
 
@@ -573,9 +642,9 @@ void Lexer::scan_equal()
 
     if (*cursor == '=') {
         ++cursor;
-        token_stream[(int) index++].kind = Token_eq;
+        token_stream.kinds[index++] = Token_eq;
     } else {
-        token_stream[(int) index++].kind = '=';
+        token_stream.kinds[index++] = '=';
     }
 }
 
@@ -591,36 +660,36 @@ void Lexer::scan_greater()
     ++cursor;
     if (*cursor == '=') {
         ++cursor;
-        token_stream[(int) index++].kind = Token_geq;
+        token_stream.kinds[index++] = Token_geq;
     } else if (*cursor == '>') {
         ++cursor;
         if (*cursor == '=') {
             ++cursor;
-            token_stream[(int) index++].kind = Token_assign;
+            token_stream.kinds[index++] = Token_assign;
         } else {
-            token_stream[(int) index++].kind = Token_shift;
+            token_stream.kinds[index++] = Token_shift;
         }
     } else {
-        token_stream[(int) index++].kind = '>';
+        token_stream.kinds[index++] = '>';
     }
 }
 
 void Lexer::scan_question()
 {
     ++cursor;
-    token_stream[(int) index++].kind = '?';
+    token_stream.kinds[index++] = '?';
 }
 
 void Lexer::scan_left_bracket()
 {
     ++cursor;
-    token_stream[(int) index++].kind = '[';
+    token_stream.kinds[index++] = '[';
 }
 
 void Lexer::scan_right_bracket()
 {
     ++cursor;
-    token_stream[(int) index++].kind = ']';
+    token_stream.kinds[index++] = ']';
 }
 
 void Lexer::scan_xor()
@@ -633,16 +702,18 @@ void Lexer::scan_xor()
 
     if (*cursor == '=') {
         ++cursor;
-        token_stream[(int) index++].kind = Token_assign;
+        token_stream.kinds[index++] = Token_assign;
     } else {
-        token_stream[(int) index++].kind = '^';
+        token_stream.kinds[index++] = '^';
     }
 }
 
 void Lexer::scan_left_brace()
 {
     ++cursor;
-    token_stream[(int) index++].kind = '{';
+    token_stream.extras[index].right_brace = 0;
+    open_braces.push_back(index);
+    token_stream.kinds[index++] = '{';
 }
 
 void Lexer::scan_or()
@@ -655,31 +726,35 @@ void Lexer::scan_or()
     ++cursor;
     if (*cursor == '=') {
         ++cursor;
-        token_stream[(int) index++].kind = Token_assign;
+        token_stream.kinds[index++] = Token_assign;
     } else if (*cursor == '|') {
         ++cursor;
-        token_stream[(int) index++].kind = Token_or;
+        token_stream.kinds[index++] = Token_or;
     } else {
-        token_stream[(int) index++].kind = '|';
+        token_stream.kinds[index++] = '|';
     }
 }
 
 void Lexer::scan_right_brace()
 {
     ++cursor;
-    token_stream[(int) index++].kind = '}';
+    if (!open_braces.empty()) {
+        token_stream.extras[open_braces.back()].right_brace = index;
+        open_braces.pop_back();
+    }
+    token_stream.kinds[index++] = '}';
 }
 
 void Lexer::scan_tilde()
 {
     ++cursor;
-    token_stream[(int) index++].kind = '~';
+    token_stream.kinds[index++] = '~';
 }
 
 void Lexer::scan_EOF()
 {
     ++cursor;
-    token_stream[(int) index++].kind = Token_EOF;
+    token_stream.kinds[index++] = Token_EOF;
 }
 
 void Lexer::scan_invalid_input()
@@ -690,6 +765,63 @@ void Lexer::scan_invalid_input()
     ++cursor;
 }
 
+std::size_t TokenStream::tokenSize(std::size_t i) const
+{
+    // scans the token again the way the lexer did
+    const unsigned char *begin = reinterpret_cast<const unsigned char *>(text) + positions[i];
+    const unsigned char *end = begin;
+
+    switch (kinds[i]) {
+    case Token_EOF:
+        return 0;
+
+    case Token_char_literal:
+    case Token_string_literal: {
+        if (*end == 'L')
+            ++end;
+        unsigned char quote = *end++;
+        while (*end && *end != quote) {
+            if (*end == '\\')
+                ++end;
+            ++end;
+        }
+        return end + 1 - begin;
+    }
+
+    case Token_number_literal:
+        while (isalnum(*end) || *end == '.')
+            ++end;
+        return end - begin;
+
+    default:
+        break;
+    }
+
+    // identifiers, keywords and the alternative spellings of operators
+    if (isalpha(*begin) || *begin == '_') {
+        while (isalnum(*end) || *end == '_')
+            ++end;
+        return end - begin;
+    }
+
+    switch (kinds[i]) {
+    case Token_assign:
+        while (*end != '=')
+            ++end;
+        return end + 1 - begin;
+
+    case Token_ellipsis:
+        return 3;
+
+    case Token_ptrmem:
+        // '.*', or the '*' following the arrow of '->*'
+        return *begin == '.' ? 2 : 1;
+
+    default:
+        return kinds[i] < 256 ? 1 : 2;
+    }
+}
+
 void LocationTable::positionAt(std::size_t offset, int max_line,
                                int *line, int *column) const
 {
@@ -723,973 +855,4 @@ void LocationTable::positionAt(std::size_t offset, int max_line,
     }
 }
 
-void Lexer::scanKeyword0()
-{
-    token_stream[(int) index++].kind = Token_identifier;
-}
-
-void Lexer::scanKeyword2()
-{
-    switch (*cursor) {
-    case 'i':
-        if (*(cursor + 1) == 'f') {
-            token_stream[(int) index++].kind = Token_if;
-            return;
-        }
-        break;
-
-    case 'd':
-        if (*(cursor + 1) == 'o') {
-            token_stream[(int) index++].kind = Token_do;
-            return;
-        }
-        break;
-
-    case 'o':
-        if (*(cursor + 1) == 'r') {
-            token_stream[(int) index++].kind = Token_or;
-            return;
-        }
-        break;
-
-    }
-    token_stream[(int) index++].kind = Token_identifier;
-}
-
-void Lexer::scanKeyword3()
-{
-    switch (*cursor) {
-    case 'a':
-        if (*(cursor + 1) == 'n' &&
-            *(cursor + 2) == 'd') {
-            token_stream[(int) index++].kind = Token_and;
-            return;
-        }
-        if (*(cursor + 1) == 's' &&
-            *(cursor + 2) == 'm') {
-            token_stream[(int) index++].kind = Token_asm;
-            return;
-        }
-        break;
-
-    case 'f':
-        if (*(cursor + 1) == 'o' &&
-            *(cursor + 2) == 'r') {
-            token_stream[(int) index++].kind = Token_for;
-            return;
-        }
-        break;
-
-    case 'i':
-        if (*(cursor + 1) == 'n' &&
-            *(cursor + 2) == 't') {
-            token_stream[(int) index++].kind = Token_int;
-            return;
-        }
-        break;
-
-    case 'n':
-        if (*(cursor + 1) == 'e' &&
-            *(cursor + 2) == 'w') {
-            token_stream[(int) index++].kind = Token_new;
-            return;
-        }
-        if (*(cursor + 1) == 'o' &&
-            *(cursor + 2) == 't') {
-            token_stream[(int) index++].kind = Token_not;
-            return;
-        }
-        break;
-
-    case 't':
-        if (*(cursor + 1) == 'r' &&
-            *(cursor + 2) == 'y') {
-            token_stream[(int) index++].kind = Token_try;
-            return;
-        }
-        break;
-
-    case 'x':
-        if (*(cursor + 1) == 'o' &&
-            *(cursor + 2) == 'r') {
-            token_stream[(int) index++].kind = Token_xor;
-            return;
-        }
-        break;
-
-    }
-    token_stream[(int) index++].kind = Token_identifier;
-}
-
-void Lexer::scanKeyword4()
-{
-    switch (*cursor) {
-    case 'a':
-        if (*(cursor + 1) == 'u' &&
-            *(cursor + 2) == 't' &&
-            *(cursor + 3) == 'o') {
-            token_stream[(int) index++].kind = Token_auto;
-            return;
-        }
-        break;
-
-    case 'c':
-        if (*(cursor + 1) == 'a' &&
-            *(cursor + 2) == 's' &&
-            *(cursor + 3) == 'e') {
-            token_stream[(int) index++].kind = Token_case;
-            return;
-        }
-        if (*(cursor + 1) == 'h' &&
-            *(cursor + 2) == 'a' &&
-            *(cursor + 3) == 'r') {
-            token_stream[(int) index++].kind = Token_char;
-            return;
-        }
-        break;
-
-    case 'b':
-        if (*(cursor + 1) == 'o' &&
-            *(cursor + 2) == 'o' &&
-            *(cursor + 3) == 'l') {
-            token_stream[(int) index++].kind = Token_bool;
-            return;
-        }
-        break;
-
-    case 'e':
-        if (*(cursor + 1) == 'l' &&
-            *(cursor + 2) == 's' &&
-            *(cursor + 3) == 'e') {
-            token_stream[(int) index++].kind = Token_else;
-            return;
-        }
-        if (*(cursor + 1) == 'm' &&
-            *(cursor + 2) == 'i' &&
-            *(cursor + 3) == 't') {
-            token_stream[(int) index++].kind = Token_emit;
-            return;
-        }
-        if (*(cursor + 1) == 'n' &&
-            *(cursor + 2) == 'u' &&
-            *(cursor + 3) == 'm') {
-            token_stream[(int) index++].kind = Token_enum;
-            return;
-        }
-        break;
-
-    case 'g':
-        if (*(cursor + 1) == 'o' &&
-            *(cursor + 2) == 't' &&
-            *(cursor + 3) == 'o') {
-            token_stream[(int) index++].kind = Token_goto;
-            return;
-        }
-        break;
-
-    case 'l':
-        if (*(cursor + 1) == 'o' &&
-            *(cursor + 2) == 'n' &&
-            *(cursor + 3) == 'g') {
-            token_stream[(int) index++].kind = Token_long;
-            return;
-        }
-        break;
-
-    case 't':
-        if (*(cursor + 1) == 'h' &&
-            *(cursor + 2) == 'i' &&
-            *(cursor + 3) == 's') {
-            token_stream[(int) index++].kind = Token_this;
-            return;
-        }
-        break;
-
-    case 'v':
-        if (*(cursor + 1) == 'o' &&
-            *(cursor + 2) == 'i' &&
-            *(cursor + 3) == 'd') {
-            token_stream[(int) index++].kind = Token_void;
-            return;
-        }
-        break;
-
-    }
-    token_stream[(int) index++].kind = Token_identifier;
-}
-
-void Lexer::scanKeyword5()
-{
-    switch (*cursor) {
-    case 'c':
-        if (*(cursor + 1) == 'a' &&
-            *(cursor + 2) == 't' &&
-            *(cursor + 3) == 'c' &&
-            *(cursor + 4) == 'h') {
-            token_stream[(int) index++].kind = Token_catch;
-            return;
-        }
-        if (*(cursor + 1) == 'l' &&
-            *(cursor + 2) == 'a' &&
-            *(cursor + 3) == 's' &&
-            *(cursor + 4) == 's') {
-            token_stream[(int) index++].kind = Token_class;
-            return;
-        }
-        if (*(cursor + 1) == 'o' &&
-            *(cursor + 2) == 'm' &&
-            *(cursor + 3) == 'p' &&
-            *(cursor + 4) == 'l') {
-            token_stream[(int) index++].kind = Token_compl;
-            return;
-        }
-        if (*(cursor + 1) == 'o' &&
-            *(cursor + 2) == 'n' &&
-            *(cursor + 3) == 's' &&
-            *(cursor + 4) == 't') {
-            token_stream[(int) index++].kind = Token_const;
-            return;
-        }
-        break;
-
-    case 'b':
-        if (*(cursor + 1) == 'i' &&
-            *(cursor + 2) == 't' &&
-            *(cursor + 3) == 'o' &&
-            *(cursor + 4) == 'r') {
-            token_stream[(int) index++].kind = Token_bitor;
-            return;
-        }
-        if (*(cursor + 1) == 'r' &&
-            *(cursor + 2) == 'e' &&
-            *(cursor + 3) == 'a' &&
-            *(cursor + 4) == 'k') {
-            token_stream[(int) index++].kind = Token_break;
-            return;
-        }
-        break;
-
-    case 'f':
-        if (*(cursor + 1) == 'l' &&
-            *(cursor + 2) == 'o' &&
-            *(cursor + 3) == 'a' &&
-            *(cursor + 4) == 't') {
-            token_stream[(int) index++].kind = Token_float;
-            return;
-        }
-        break;
-
-    case 'o':
-        if (*(cursor + 1) == 'r' &&
-            *(cursor + 2) == '_' &&
-            *(cursor + 3) == 'e' &&
-            *(cursor + 4) == 'q') {
-            token_stream[(int) index++].kind = Token_or_eq;
-            return;
-        }
-        break;
-
-    case 's':
-        if (*(cursor + 1) == 'h' &&
-            *(cursor + 2) == 'o' &&
-            *(cursor + 3) == 'r' &&
-            *(cursor + 4) == 't') {
-            token_stream[(int) index++].kind = Token_short;
-            return;
-        }
-        if (*(cursor + 1) == 'l' &&
-            *(cursor + 2) == 'o' &&
-            *(cursor + 3) == 't' &&
-            *(cursor + 4) == 's') {
-            token_stream[(int) index++].kind = Token_slots;
-            return;
-        }
-        break;
-
-    case 'u':
-        if (*(cursor + 1) == 'n' &&
-            *(cursor + 2) == 'i' &&
-            *(cursor + 3) == 'o' &&
-            *(cursor + 4) == 'n') {
-            token_stream[(int) index++].kind = Token_union;
-            return;
-        }
-        if (*(cursor + 1) == 's' &&
-            *(cursor + 2) == 'i' &&
-            *(cursor + 3) == 'n' &&
-            *(cursor + 4) == 'g') {
-            token_stream[(int) index++].kind = Token_using;
-            return;
-        }
-        break;
-
-    case 't':
-        if (*(cursor + 1) == 'h' &&
-            *(cursor + 2) == 'r' &&
-            *(cursor + 3) == 'o' &&
-            *(cursor + 4) == 'w') {
-            token_stream[(int) index++].kind = Token_throw;
-            return;
-        }
-        break;
-
-    case 'w':
-        if (*(cursor + 1) == 'h' &&
-            *(cursor + 2) == 'i' &&
-            *(cursor + 3) == 'l' &&
-            *(cursor + 4) == 'e') {
-            token_stream[(int) index++].kind = Token_while;
-            return;
-        }
-        break;
-
-    }
-    token_stream[(int) index++].kind = Token_identifier;
-}
-
-void Lexer::scanKeyword6()
-{
-    switch (*cursor) {
-    case 'a':
-        if (*(cursor + 1) == 'n' &&
-            *(cursor + 2) == 'd' &&
-            *(cursor + 3) == '_' &&
-            *(cursor + 4) == 'e' &&
-            *(cursor + 5) == 'q') {
-            token_stream[(int) index++].kind = Token_and_eq;
-            return;
-        }
-        break;
-
-    case 'b':
-        if (*(cursor + 1) == 'i' &&
-            *(cursor + 2) == 't' &&
-            *(cursor + 3) == 'a' &&
-            *(cursor + 4) == 'n' &&
-            *(cursor + 5) == 'd') {
-            token_stream[(int) index++].kind = Token_bitand;
-            return;
-        }
-        break;
-
-    case 'e':
-        if (*(cursor + 1) == 'x' &&
-            *(cursor + 2) == 'p' &&
-            *(cursor + 3) == 'o' &&
-            *(cursor + 4) == 'r' &&
-            *(cursor + 5) == 't') {
-            token_stream[(int) index++].kind = Token_export;
-            return;
-        }
-        if (*(cursor + 1) == 'x' &&
-            *(cursor + 2) == 't' &&
-            *(cursor + 3) == 'e' &&
-            *(cursor + 4) == 'r' &&
-            *(cursor + 5) == 'n') {
-            token_stream[(int) index++].kind = Token_extern;
-            return;
-        }
-        break;
-
-    case 'd':
-        if (*(cursor + 1) == 'e' &&
-            *(cursor + 2) == 'l' &&
-            *(cursor + 3) == 'e' &&
-            *(cursor + 4) == 't' &&
-            *(cursor + 5) == 'e') {
-            token_stream[(int) index++].kind = Token_delete;
-            return;
-        }
-        if (*(cursor + 1) == 'o' &&
-            *(cursor + 2) == 'u' &&
-            *(cursor + 3) == 'b' &&
-            *(cursor + 4) == 'l' &&
-            *(cursor + 5) == 'e') {
-            token_stream[(int) index++].kind = Token_double;
-            return;
-        }
-        break;
-
-    case 'f':
-        if (*(cursor + 1) == 'r' &&
-            *(cursor + 2) == 'i' &&
-            *(cursor + 3) == 'e' &&
-            *(cursor + 4) == 'n' &&
-            *(cursor + 5) == 'd') {
-            token_stream[(int) index++].kind = Token_friend;
-            return;
-        }
-        break;
-
-    case 'i':
-        if (*(cursor + 1) == 'n' &&
-            *(cursor + 2) == 'l' &&
-            *(cursor + 3) == 'i' &&
-            *(cursor + 4) == 'n' &&
-            *(cursor + 5) == 'e') {
-            token_stream[(int) index++].kind = Token_inline;
-            return;
-        }
-        break;
-
-    case 'K':
-        if (*(cursor + 1) == '_' &&
-            *(cursor + 2) == 'D' &&
-            *(cursor + 3) == 'C' &&
-            *(cursor + 4) == 'O' &&
-            *(cursor + 5) == 'P') {
-            token_stream[(int) index++].kind = Token_K_DCOP;
-            return;
-        }
-        break;
-
-    case 'n':
-        if (*(cursor + 1) == 'o' &&
-            *(cursor + 2) == 't' &&
-            *(cursor + 3) == '_' &&
-            *(cursor + 4) == 'e' &&
-            *(cursor + 5) == 'q') {
-            token_stream[(int) index++].kind = Token_not_eq;
-            return;
-        }
-        break;
-
-    case 'p':
-        if (*(cursor + 1) == 'u' &&
-            *(cursor + 2) == 'b' &&
-            *(cursor + 3) == 'l' &&
-            *(cursor + 4) == 'i' &&
-            *(cursor + 5) == 'c') {
-            token_stream[(int) index++].kind = Token_public;
-            return;
-        }
-        break;
-
-    case 's':
-        if (*(cursor + 1) == 'i' &&
-            *(cursor + 2) == 'g' &&
-            *(cursor + 3) == 'n' &&
-            *(cursor + 4) == 'e' &&
-            *(cursor + 5) == 'd') {
-            token_stream[(int) index++].kind = Token_signed;
-            return;
-        }
-        if (*(cursor + 1) == 'i' &&
-            *(cursor + 2) == 'z' &&
-            *(cursor + 3) == 'e' &&
-            *(cursor + 4) == 'o' &&
-            *(cursor + 5) == 'f') {
-            token_stream[(int) index++].kind = Token_sizeof;
-            return;
-        }
-        if (*(cursor + 1) == 't' &&
-            *(cursor + 2) == 'a' &&
-            *(cursor + 3) == 't' &&
-            *(cursor + 4) == 'i' &&
-            *(cursor + 5) == 'c') {
-            token_stream[(int) index++].kind = Token_static;
-            return;
-        }
-        if (*(cursor + 1) == 't' &&
-            *(cursor + 2) == 'r' &&
-            *(cursor + 3) == 'u' &&
-            *(cursor + 4) == 'c' &&
-            *(cursor + 5) == 't') {
-            token_stream[(int) index++].kind = Token_struct;
-            return;
-        }
-        if (*(cursor + 1) == 'w' &&
-            *(cursor + 2) == 'i' &&
-            *(cursor + 3) == 't' &&
-            *(cursor + 4) == 'c' &&
-            *(cursor + 5) == 'h') {
-            token_stream[(int) index++].kind = Token_switch;
-            return;
-        }
-        break;
-
-    case 'r':
-        if (*(cursor + 1) == 'e' &&
-            *(cursor + 2) == 't' &&
-            *(cursor + 3) == 'u' &&
-            *(cursor + 4) == 'r' &&
-            *(cursor + 5) == 'n') {
-            token_stream[(int) index++].kind = Token_return;
-            return;
-        }
-        break;
-
-    case 't':
-        if (*(cursor + 1) == 'y' &&
-            *(cursor + 2) == 'p' &&
-            *(cursor + 3) == 'e' &&
-            *(cursor + 4) == 'i' &&
-            *(cursor + 5) == 'd') {
-            token_stream[(int) index++].kind = Token_typeid;
-            return;
-        }
-        break;
-
-    case 'x':
-        if (*(cursor + 1) == 'o' &&
-            *(cursor + 2) == 'r' &&
-            *(cursor + 3) == '_' &&
-            *(cursor + 4) == 'e' &&
-            *(cursor + 5) == 'q') {
-            token_stream[(int) index++].kind = Token_xor_eq;
-            return;
-        }
-        break;
-
-    case 'k':
-        if (*(cursor + 1) == '_' &&
-            *(cursor + 2) == 'd' &&
-            *(cursor + 3) == 'c' &&
-            *(cursor + 4) == 'o' &&
-            *(cursor + 5) == 'p') {
-            token_stream[(int) index++].kind = Token_k_dcop;
-            return;
-        }
-        break;
-
-    }
-    token_stream[(int) index++].kind = Token_identifier;
-}
-
-void Lexer::scanKeyword7()
-{
-    switch (*cursor) {
-    case 'd':
-        if (*(cursor + 1) == 'e' &&
-            *(cursor + 2) == 'f' &&
-            *(cursor + 3) == 'a' &&
-            *(cursor + 4) == 'u' &&
-            *(cursor + 5) == 'l' &&
-            *(cursor + 6) == 't') {
-            token_stream[(int) index++].kind = Token_default;
-            return;
-        }
-        break;
-
-    case 'm':
-        if (*(cursor + 1) == 'u' &&
-            *(cursor + 2) == 't' &&
-            *(cursor + 3) == 'a' &&
-            *(cursor + 4) == 'b' &&
-            *(cursor + 5) == 'l' &&
-            *(cursor + 6) == 'e') {
-            token_stream[(int) index++].kind = Token_mutable;
-            return;
-        }
-        break;
-
-    case 'p':
-        if (*(cursor + 1) == 'r' &&
-            *(cursor + 2) == 'i' &&
-            *(cursor + 3) == 'v' &&
-            *(cursor + 4) == 'a' &&
-            *(cursor + 5) == 't' &&
-            *(cursor + 6) == 'e') {
-            token_stream[(int) index++].kind = Token_private;
-            return;
-        }
-        break;
-    case 's':
-        if (*(cursor + 1) == 'i' &&
-            *(cursor + 2) == 'g' &&
-            *(cursor + 3) == 'n' &&
-            *(cursor + 4) == 'a' &&
-            *(cursor + 5) == 'l' &&
-            *(cursor + 6) == 's') {
-            token_stream[(int) index++].kind = Token_signals;
-            return;
-        }
-        break;
-    case 't':
-        if (*(cursor + 1) == 'y' &&
-            *(cursor + 2) == 'p' &&
-            *(cursor + 3) == 'e' &&
-            *(cursor + 4) == 'd' &&
-            *(cursor + 5) == 'e' &&
-            *(cursor + 6) == 'f') {
-            token_stream[(int) index++].kind = Token_typedef;
-            return;
-        }
-        break;
-
-    case 'v':
-        if (*(cursor + 1) == 'i' &&
-            *(cursor + 2) == 'r' &&
-            *(cursor + 3) == 't' &&
-            *(cursor + 4) == 'u' &&
-            *(cursor + 5) == 'a' &&
-            *(cursor + 6) == 'l') {
-            token_stream[(int) index++].kind = Token_virtual;
-            return;
-        }
-        break;
-
-    case 'Q':
-        if (*(cursor + 1) == '_' &&
-            *(cursor + 2) == 'E' &&
-            *(cursor + 3) == 'N' &&
-            *(cursor + 4) == 'U' &&
-            *(cursor + 5) == 'M' &&
-            *(cursor + 6) == 'S') {
-            token_stream[(int) index++].kind = Token_Q_ENUMS;
-            return;
-        }
-        break;
-
-    }
-    token_stream[(int) index++].kind = Token_identifier;
-}
-
-void Lexer::scanKeyword8()
-{
-    switch (*cursor) {
-    case '_':
-        if (*(cursor + 1) == '_' &&
-            *(cursor + 2) == 't' &&
-            *(cursor + 3) == 'y' &&
-            *(cursor + 4) == 'p' &&
-            *(cursor + 5) == 'e' &&
-            *(cursor + 6) == 'o' &&
-            *(cursor + 7) == 'f') {
-            token_stream[(int) index++].kind = Token___typeof;
-            return;
-        }
-        break;
-
-    case 'c':
-        if (*(cursor + 1) == 'o' &&
-            *(cursor + 2) == 'n' &&
-            *(cursor + 3) == 't' &&
-            *(cursor + 4) == 'i' &&
-            *(cursor + 5) == 'n' &&
-            *(cursor + 6) == 'u' &&
-            *(cursor + 7) == 'e') {
-            token_stream[(int) index++].kind = Token_continue;
-            return;
-        }
-        break;
-
-    case 'e':
-        if (*(cursor + 1) == 'x' &&
-            *(cursor + 2) == 'p' &&
-            *(cursor + 3) == 'l' &&
-            *(cursor + 4) == 'i' &&
-            *(cursor + 5) == 'c' &&
-            *(cursor + 6) == 'i' &&
-            *(cursor + 7) == 't') {
-            token_stream[(int) index++].kind = Token_explicit;
-            return;
-        }
-        break;
-
-    case 'o':
-        if (*(cursor + 1) == 'p' &&
-            *(cursor + 2) == 'e' &&
-            *(cursor + 3) == 'r' &&
-            *(cursor + 4) == 'a' &&
-            *(cursor + 5) == 't' &&
-            *(cursor + 6) == 'o' &&
-            *(cursor + 7) == 'r') {
-            token_stream[(int) index++].kind = Token_operator;
-            return;
-        }
-        break;
-
-    case 'Q':
-        if (*(cursor + 1) == '_' &&
-            *(cursor + 2) == 'O' &&
-            *(cursor + 3) == 'B' &&
-            *(cursor + 4) == 'J' &&
-            *(cursor + 5) == 'E' &&
-            *(cursor + 6) == 'C' &&
-            *(cursor + 7) == 'T') {
-            token_stream[(int) index++].kind = Token_Q_OBJECT;
-            return;
-        }
-        break;
-
-    case 'r':
-        if (*(cursor + 1) == 'e' &&
-            *(cursor + 2) == 'g' &&
-            *(cursor + 3) == 'i' &&
-            *(cursor + 4) == 's' &&
-            *(cursor + 5) == 't' &&
-            *(cursor + 6) == 'e' &&
-            *(cursor + 7) == 'r') {
-            token_stream[(int) index++].kind = Token_register;
-            return;
-        }
-        break;
-
-    case 'u':
-        if (*(cursor + 1) == 'n' &&
-            *(cursor + 2) == 's' &&
-            *(cursor + 3) == 'i' &&
-            *(cursor + 4) == 'g' &&
-            *(cursor + 5) == 'n' &&
-            *(cursor + 6) == 'e' &&
-            *(cursor + 7) == 'd') {
-            token_stream[(int) index++].kind = Token_unsigned;
-            return;
-        }
-        break;
-
-    case 't':
-        if (*(cursor + 1) == 'e' &&
-            *(cursor + 2) == 'm' &&
-            *(cursor + 3) == 'p' &&
-            *(cursor + 4) == 'l' &&
-            *(cursor + 5) == 'a' &&
-            *(cursor + 6) == 't' &&
-            *(cursor + 7) == 'e') {
-            token_stream[(int) index++].kind = Token_template;
-            return;
-        }
-        if (*(cursor + 1) == 'y' &&
-            *(cursor + 2) == 'p' &&
-            *(cursor + 3) == 'e' &&
-            *(cursor + 4) == 'n' &&
-            *(cursor + 5) == 'a' &&
-            *(cursor + 6) == 'm' &&
-            *(cursor + 7) == 'e') {
-            token_stream[(int) index++].kind = Token_typename;
-            return;
-        }
-        break;
-
-    case 'v':
-        if (*(cursor + 1) == 'o' &&
-            *(cursor + 2) == 'l' &&
-            *(cursor + 3) == 'a' &&
-            *(cursor + 4) == 't' &&
-            *(cursor + 5) == 'i' &&
-            *(cursor + 6) == 'l' &&
-            *(cursor + 7) == 'e') {
-            token_stream[(int) index++].kind = Token_volatile;
-            return;
-        }
-        break;
-
-    }
-    token_stream[(int) index++].kind = Token_identifier;
-}
-
-void Lexer::scanKeyword9()
-{
-    switch (*cursor) {
-    case 'p':
-        if (*(cursor + 1) == 'r' &&
-            *(cursor + 2) == 'o' &&
-            *(cursor + 3) == 't' &&
-            *(cursor + 4) == 'e' &&
-            *(cursor + 5) == 'c' &&
-            *(cursor + 6) == 't' &&
-            *(cursor + 7) == 'e' &&
-            *(cursor + 8) == 'd') {
-            token_stream[(int) index++].kind = Token_protected;
-            return;
-        }
-        break;
-
-    case 'n':
-        if (*(cursor + 1) == 'a' &&
-            *(cursor + 2) == 'm' &&
-            *(cursor + 3) == 'e' &&
-            *(cursor + 4) == 's' &&
-            *(cursor + 5) == 'p' &&
-            *(cursor + 6) == 'a' &&
-            *(cursor + 7) == 'c' &&
-            *(cursor + 8) == 'e') {
-            token_stream[(int) index++].kind = Token_namespace;
-            return;
-        }
-        break;
-
-    }
-    token_stream[(int) index++].kind = Token_identifier;
-}
-
-void Lexer::scanKeyword10()
-{
-    switch (*cursor) {
-    case 'c':
-        if (*(cursor + 1) == 'o' &&
-            *(cursor + 2) == 'n' &&
-            *(cursor + 3) == 's' &&
-            *(cursor + 4) == 't' &&
-            *(cursor + 5) == '_' &&
-            *(cursor + 6) == 'c' &&
-            *(cursor + 7) == 'a' &&
-            *(cursor + 8) == 's' &&
-            *(cursor + 9) == 't') {
-            token_stream[(int) index++].kind = Token_const_cast;
-            return;
-        }
-        break;
-
-    case 'Q':
-        if (*(cursor + 1) == '_' &&
-            *(cursor + 2) == 'P' &&
-            *(cursor + 3) == 'R' &&
-            *(cursor + 4) == 'O' &&
-            *(cursor + 5) == 'P' &&
-            *(cursor + 6) == 'E' &&
-            *(cursor + 7) == 'R' &&
-            *(cursor + 8) == 'T' &&
-            *(cursor + 9) == 'Y') {
-            token_stream[(int) index++].kind = Token_Q_PROPERTY;
-            return;
-        }
-
-        break;
-    }
-
-    token_stream[(int) index++].kind = Token_identifier;
-}
-
-void Lexer::scanKeyword11()
-{
-    switch (*cursor) {
-    case 'Q':
-        if (*(cursor + 1) == '_' &&
-            *(cursor + 2) == 'I' &&
-            *(cursor + 3) == 'N' &&
-            *(cursor + 4) == 'V' &&
-            *(cursor + 5) == 'O' &&
-            *(cursor + 6) == 'K' &&
-            *(cursor + 7) == 'A' &&
-            *(cursor + 8) == 'B' &&
-            *(cursor + 9) == 'L' &&
-            *(cursor + 10) == 'E') {
-            token_stream[(int) index++].kind = Token_Q_INVOKABLE;
-            return;
-        }
-        break;
-
-    case 's':
-        if (*(cursor + 1) == 't' &&
-            *(cursor + 2) == 'a' &&
-            *(cursor + 3) == 't' &&
-            *(cursor + 4) == 'i' &&
-            *(cursor + 5) == 'c' &&
-            *(cursor + 6) == '_' &&
-            *(cursor + 7) == 'c' &&
-            *(cursor + 8) == 'a' &&
-            *(cursor + 9) == 's' &&
-            *(cursor + 10) == 't') {
-            token_stream[(int) index++].kind = Token_static_cast;
-            return;
-        }
-        break;
-
-    }
-    token_stream[(int) index++].kind = Token_identifier;
-}
-
-void Lexer::scanKeyword12()
-{
-    switch (*cursor) {
-    case 'd':
-        if (*(cursor + 1) == 'y' &&
-            *(cursor + 2) == 'n' &&
-            *(cursor + 3) == 'a' &&
-            *(cursor + 4) == 'm' &&
-            *(cursor + 5) == 'i' &&
-            *(cursor + 6) == 'c' &&
-            *(cursor + 7) == '_' &&
-            *(cursor + 8) == 'c' &&
-            *(cursor + 9) == 'a' &&
-            *(cursor + 10) == 's' &&
-            *(cursor + 11) == 't') {
-            token_stream[(int) index++].kind = Token_dynamic_cast;
-            return;
-        }
-        break;
-
-    }
-    token_stream[(int) index++].kind = Token_identifier;
-}
-
-void Lexer::scanKeyword13()
-{
-    switch (*cursor) {
-    case '_':
-        if (*(cursor + 1) == '_' &&
-            *(cursor + 2) == 'a' &&
-            *(cursor + 3) == 't' &&
-            *(cursor + 4) == 't' &&
-            *(cursor + 5) == 'r' &&
-            *(cursor + 6) == 'i' &&
-            *(cursor + 7) == 'b' &&
-            *(cursor + 8) == 'u' &&
-            *(cursor + 9) == 't' &&
-            *(cursor + 10) == 'e' &&
-            *(cursor + 11) == '_' &&
-            *(cursor + 12) == '_') {
-            token_stream[(int) index++].kind = Token___attribute__;
-            return;
-        }
-        break;
-    }
-    token_stream[(int) index++].kind = Token_identifier;
-}
-
-void Lexer::scanKeyword14()
-{
-    switch (*cursor) {
-    case 'k':
-        if (*(cursor + 1) == '_' &&
-            *(cursor + 2) == 'd' &&
-            *(cursor + 3) == 'c' &&
-            *(cursor + 4) == 'o' &&
-            *(cursor + 5) == 'p' &&
-            *(cursor + 6) == '_' &&
-            *(cursor + 7) == 's' &&
-            *(cursor + 8) == 'i' &&
-            *(cursor + 9) == 'g' &&
-            *(cursor + 10) == 'n' &&
-            *(cursor + 11) == 'a' &&
-            *(cursor + 12) == 'l' &&
-            *(cursor + 13) == 's') {
-            token_stream[(int) index++].kind = Token_k_dcop_signals;
-            return;
-        }
-        break;
-    }
-    token_stream[(int) index++].kind = Token_identifier;
-}
-
-void Lexer::scanKeyword16()
-{
-    switch (*cursor) {
-    case 'r':
-        if (*(cursor + 1) == 'e' &&
-            *(cursor + 2) == 'i' &&
-            *(cursor + 3) == 'n' &&
-            *(cursor + 4) == 't' &&
-            *(cursor + 5) == 'e' &&
-            *(cursor + 6) == 'r' &&
-            *(cursor + 7) == 'p' &&
-            *(cursor + 8) == 'r' &&
-            *(cursor + 9) == 'e' &&
-            *(cursor + 10) == 't' &&
-            *(cursor + 11) == '_' &&
-            *(cursor + 12) == 'c' &&
-            *(cursor + 13) == 'a' &&
-            *(cursor + 14) == 's' &&
-            *(cursor + 15) == 't') {
-            token_stream[(int) index++].kind = Token_reinterpret_cast;
-            return;
-        }
-        break;
-    }
-
-    token_stream[(int) index++].kind = Token_identifier;
-}
-
 // kate: space-indent on; indent-width 2; replace-tabs on;
@@ -28,9 +28,14 @@
 
 #include "symbol.h"
 
+#include <QtCore/QHash>
+#include <QtCore/QList>
 #include <QtCore/QString>
 #include <cstdlib>
 #include <cassert>
+#include <vector>
+#include <string>
+#include <iterator>
 
 struct NameSymbol;
 class Lexer;
@@ -38,6 +43,11 @@ class Control;
 
 typedef void (Lexer::*scan_fun_ptr)();
 
+union TokenExtra {
+    const NameSymbol *symbol;
+    std::size_t right_brace;
+};
+
 class Token
 {
 public:
@@ -45,11 +55,7 @@ public:
     std::size_t position;
     std::size_t size;
     char const *text;
-
-    union {
-        const NameSymbol *symbol;
-        std::size_t right_brace;
-    } extra;
+    TokenExtra extra;
 };
 
 class LocationTable
@@ -98,6 +104,12 @@ private:
     friend class Lexer;
 };
 
+/**
+*   The tokens of a translation unit. They are kept in parallel arrays
+*   rather than as Token objects: a kind takes 16 bits and a position 32,
+*   which limits the text to 4GB, while the sizes are worked out from the
+*   text when they are asked for. token() makes Token objects on demand.
+*/
 class TokenStream
 {
 private:
@@ -106,20 +118,55 @@ private:
 
 public:
     inline TokenStream(std::size_t size = 1024)
-            : tokens(0),
+            : text(0),
+            kinds(0),
+            positions(0),
+            extras(0),
             index(0),
-            token_count(0) {
+            token_count(0),
+            end_index(0),
+            shared(false) {
         resize(size);
     }
 
     inline ~TokenStream() {
-        ::free(tokens);
+        if (!shared) {
+            ::free(kinds);
+            ::free(positions);
+            ::free(extras);
+        }
+    }
+
+    /**
+    *   Reads the tokens of \a other with a cursor of its own. They must
+    *   not change while this stream reads them, nor go away before it.
+    */
+    void share(const TokenStream &other) {
+        if (!shared) {
+            ::free(kinds);
+            ::free(positions);
+            ::free(extras);
+        }
+        text = other.text;
+        kinds = other.kinds;
+        positions = other.positions;
+        extras = other.extras;
+        index = 0;
+        token_count = other.token_count;
+        end_index = other.end_index;
+        shared = true;
     }
 
+    // the room for tokens, which is more than there are
     inline std::size_t size() const {
         return token_count;
     }
 
+    // the index of the EOF token the lexer ended the tokens with
+    inline std::size_t end() const {
+        return end_index;
+    }
+
     inline std::size_t cursor() const {
         return index;
     }
@@ -129,8 +176,10 @@ public:
     }
 
     void resize(std::size_t size) {
-        Q_ASSERT(size > 0);
-        tokens = (Token*) ::realloc(tokens, sizeof(Token) * size);
+        Q_ASSERT(size > 0 && !shared);
+        kinds = (unsigned short*) ::realloc(kinds, sizeof(unsigned short) * size);
+        positions = (unsigned int*) ::realloc(positions, sizeof(unsigned int) * size);
+        extras = (TokenExtra*) ::realloc(extras, sizeof(TokenExtra) * size);
         token_count = size;
     }
 
@@ -139,37 +188,53 @@ public:
     }
 
     inline int lookAhead(std::size_t i = 0) const {
-        return tokens[index + i].kind;
+        return kinds[index + i];
     }
 
     inline int kind(std::size_t i) const {
-        return tokens[i].kind;
+        return kinds[i];
     }
 
     inline std::size_t position(std::size_t i) const {
-        return tokens[i].position;
+        return positions[i];
     }
 
     inline const NameSymbol *symbol(std::size_t i) const {
-        return tokens[i].extra.symbol;
+        return extras[i].symbol;
     }
 
+    // the index of the '}' closing the '{' at \a i, 0 when it is unbalanced
     inline std::size_t matchingBrace(std::size_t i) const {
-        return tokens[i].extra.right_brace;
+        return extras[i].right_brace;
     }
 
-    inline Token &operator[](int index) {
-        return tokens[index];
+    // the length of the text of the token at \a i
+    std::size_t tokenSize(std::size_t i) const;
+
+    // the text the positions are offsets into
+    inline const char *contents() const {
+        return text;
     }
 
-    inline const Token &token(int index) const {
-        return tokens[index];
+    inline Token token(int index) const {
+        Token tk;
+        tk.kind = kinds[index];
+        tk.position = positions[index];
+        tk.size = tokenSize(index);
+        tk.text = text;
+        tk.extra = extras[index];
+        return tk;
     }
 
 private:
-    Token *tokens;
+    const char *text;
+    unsigned short *kinds;
+    unsigned int *positions;
+    TokenExtra *extras;
     std::size_t index;
     std::size_t token_count;
+    std::size_t end_index;
+    bool shared;
 
 private:
     friend class Lexer;
@@ -191,11 +256,29 @@ public:
     void positionAt(std::size_t offset, int *line, int *column,
                     QString *filename) const;
 
-    void extract_line(int offset, int *line, QString *filename) const;
+    /**
+    *   Called by the lexer for each line of preprocessor output starting
+    *   with '#', in the order of line_table. A '# line "file"' marker is
+    *   decoded once here, so that positionAt() needs no rescanning of the
+    *   text; \a ppline is the line of the marker in the preprocessed text.
+    */
+    void addLineMarker(const unsigned char *marker, std::size_t ppline);
+    void clearLineMarkers();
 
     TokenStream &token_stream;
     LocationTable &location_table;
     LocationTable &line_table;
+
+private:
+    struct LineMarker {
+        int line;
+        int file;   // index in file_names, -1 when not a line marker
+        int ppline;
+    };
+
+    std::vector<LineMarker> line_markers;
+    QList<QString> file_names;
+    QHash<QString, int> file_index;
 };
 
 class Lexer
@@ -206,10 +289,27 @@ public:
             token_stream(_M_location.token_stream),
             location_table(_M_location.location_table),
             line_table(_M_location.line_table),
-            control(__control) {}
-
+            control(__control),
+            streaming(false),
+            lexed(0) {}
+
+    /**
+    *   Lexes \a contents. When parts of it were fed already, only the
+    *   rest is lexed.
+    */
     void tokenize(const char *contents, std::size_t size);
 
+    /**
+    *   Lexes the complete lines of \a contents that were not lexed yet.
+    *   The text may move between calls, as long as it only grows, and
+    *   must finally be handed to tokenize().
+    */
+    void feed(const char *contents, std::size_t size);
+
+    inline std::size_t lexedSize() const {
+        return lexed;
+    }
+
     LocationManager &_M_location;
     TokenStream &token_stream;
     LocationTable &location_table;
@@ -218,6 +318,10 @@ public:
 private:
     void reportError(const QString& msg);
 
+    void start(const char *contents, std::size_t size);
+    void scan(const char *contents, std::size_t size);
+    const NameSymbol *nameSymbol(const unsigned char *begin, std::size_t size);
+
     void initialize_scan_table();
     void scan_newline();
     void scan_white_spaces();
@@ -229,23 +333,6 @@ private:
     void scan_invalid_input();
     void scan_preprocessor();
 
-    // keywords
-    void scanKeyword0();
-    void scanKeyword2();
-    void scanKeyword3();
-    void scanKeyword4();
-    void scanKeyword5();
-    void scanKeyword6();
-    void scanKeyword7();
-    void scanKeyword8();
-    void scanKeyword9();
-    void scanKeyword10();
-    void scanKeyword11();
-    void scanKeyword12();
-    void scanKeyword13();
-    void scanKeyword14();
-    void scanKeyword16();
-
     // operators
     void scan_not();
     void scan_remainder();
@@ -279,12 +366,60 @@ private:
     const unsigned char *begin_buffer;
     const unsigned char *end_buffer;
     std::size_t index;
+    bool streaming;
+    std::size_t lexed;
+    std::vector<std::size_t> open_braces;
 
     static scan_fun_ptr s_scan_table[];
-    static scan_fun_ptr s_scan_keyword_table[];
     static bool s_initialized;
 };
 
+/**
+*   An output iterator for the preprocessor, appends the translation unit to
+*   a buffer and feeds the lexer every few kilobytes. Lines are lexed while
+*   they are still in the cache instead of in a second pass over the text.
+*/
+class LexerSink : public std::iterator<std::output_iterator_tag, void, void, void, void>
+{
+public:
+    LexerSink(Lexer *lexer, std::string *buffer)
+            : _M_lexer(lexer), _M_buffer(buffer) {}
+
+    inline LexerSink &operator=(char c) {
+        _M_buffer->push_back(c);
+        if (c == '\n' && _M_buffer->size() - _M_lexer->lexedSize() >= FEED_SIZE)
+            _M_lexer->feed(_M_buffer->c_str(), _M_buffer->size());
+        return *this;
+    }
+
+    inline std::size_t size() const {
+        return _M_buffer->size();
+    }
+
+    inline LexerSink &operator*() {
+        return *this;
+    }
+    inline LexerSink &operator++() {
+        return *this;
+    }
+    inline LexerSink operator++(int) {
+        return *this;
+    }
+
+private:
+    enum { FEED_SIZE = 16 * 1024 };
+
+    Lexer *_M_lexer;
+    std::string *_M_buffer;
+};
+
+// lets the preprocessor profile count the bytes written through the sink,
+// found by argument-dependent lookup wherever the preprocessor is instantiated
+inline std::size_t pp_output_size(const LexerSink &sink)
+{
+    return sink.size();
+}
+
 #endif // LEXER_H
 
 // kate: space-indent on; indent-width 2; replace-tabs on;
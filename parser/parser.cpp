@@ -31,6 +31,11 @@
 #include "lexer.h"
 #include "control.h"
 
+#include <QtCore/QRunnable>
+#include <QtCore/QThread>
+#include <QtCore/QThreadPool>
+
+#include <algorithm>
 #include <cstdlib>
 
 #define ADVANCE(tk, descr) \
@@ -68,13 +73,22 @@
 Parser::Parser(Control *c)
         : _M_location(token_stream, location_table, line_table),
         control(c),
-        lexer(_M_location, control)
+        lexer(_M_location, control),
+        _M_positions(&_M_location)
 {
     _M_block_errors = false;
+    _M_parallel = false;
+    _M_consumer = 0;
+    _M_errors = 0;
+    _M_rewinds = 0;
+    _M_remembered = 0;
+    _M_memoizing = true;
+    _M_memo = new MemoEntry[MemoSize];
 }
 
 Parser::~Parser()
 {
+    delete[] _M_memo;
 }
 
 void Parser::advance()
@@ -82,11 +96,28 @@ void Parser::advance()
     token_stream.nextToken();
 }
 
-TranslationUnitAST *Parser::parse(const char *contents,
-                                  std::size_t size, pool *p)
+void Parser::prepare(pool *p)
 {
     _M_block_errors = false;
     _M_pool = p;
+    _M_errors = 0;
+    _M_rewinds = 0;
+    _M_remembered = 0;
+    _M_memo_reach = 0;
+    for (int i = 0; i < MemoRuleCount; ++i) {
+        _M_rule_statistics[i].calls = 0;
+        _M_rule_statistics[i].hits = 0;
+    }
+    // the tokens are new, so are the starts to remember
+    for (int i = 0; i < MemoSize; ++i)
+        _M_memo[i].rule = MemoRuleCount;
+}
+
+TranslationUnitAST *Parser::parse(const char *contents,
+                                  std::size_t size, pool *p)
+{
+    prepare(p);
+
     lexer.tokenize(contents, size);
     token_stream.nextToken(); // skip the first token
 
@@ -102,6 +133,97 @@ TranslationUnitAST *Parser::parse(const char *contents,
     return ast;
 }
 
+const char *Parser::ruleName(MemoRule rule)
+{
+    static const char *const names[MemoRuleCount] = {
+        "name", "template-name", "declarator", "abstract-declarator",
+        "type-id", "template-argument", "parameter-declaration"
+    };
+
+    return rule < MemoRuleCount ? names[rule] : 0;
+}
+
+Parser::MemoEntry *Parser::memoEntry(MemoRule rule)
+{
+    ++_M_rule_statistics[rule].calls;
+
+    if (!_M_memoizing)
+        return 0;
+
+    return &_M_memo[(token_stream.cursor() * MemoRuleCount + rule) & (MemoSize - 1)];
+}
+
+// A rule is parsed at most once at a token: a retry takes the result of
+// the first attempt, and goes to where it ended. Rules only depend on the
+// tokens, but a result isn't kept when the attempt reported errors, which
+// a retry must report again. The memoized rules set node only when they
+// succeed, so the nodes of a failed attempt are released.
+template <class Node>
+inline bool Parser::memoize(MemoRule rule, Node *&node, bool (Parser::*parse)(Node *&))
+{
+    std::size_t start = token_stream.cursor();
+    MemoEntry *entry = memoEntry(rule);
+    if (entry && entry->rule == rule && entry->start == start) {
+        ++_M_rule_statistics[rule].hits;
+        token_stream.rewind((int) entry->end);
+        if (entry->parsed)
+            node = static_cast<Node*>(entry->node);
+        return entry->parsed;
+    }
+
+    std::size_t errors = _M_errors;
+    Checkpoint attempt = checkpoint();
+    bool parsed = (this->*parse)(node);
+
+    if (!parsed)
+        release(attempt);
+
+    if (entry && _M_errors == errors) {
+        ++_M_remembered;
+        _M_memo_reach = std::max(_M_memo_reach, start);
+        entry->start = start;
+        entry->end = token_stream.cursor();
+        entry->node = parsed ? node : 0;
+        entry->rule = rule;
+        entry->parsed = parsed;
+    }
+
+    return parsed;
+}
+
+template <class Node, class Arg>
+inline bool Parser::memoize(MemoRule rule, Node *&node, bool (Parser::*parse)(Node *&, Arg), Arg arg)
+{
+    std::size_t start = token_stream.cursor();
+    MemoEntry *entry = memoEntry(rule);
+    if (entry && entry->rule == rule && entry->start == start) {
+        ++_M_rule_statistics[rule].hits;
+        token_stream.rewind((int) entry->end);
+        if (entry->parsed)
+            node = static_cast<Node*>(entry->node);
+        return entry->parsed;
+    }
+
+    std::size_t errors = _M_errors;
+    Checkpoint attempt = checkpoint();
+    bool parsed = (this->*parse)(node, arg);
+
+    if (!parsed)
+        release(attempt);
+
+    if (entry && _M_errors == errors) {
+        ++_M_remembered;
+        _M_memo_reach = std::max(_M_memo_reach, start);
+        entry->start = start;
+        entry->end = token_stream.cursor();
+        entry->node = parsed ? node : 0;
+        entry->rule = rule;
+        entry->parsed = parsed;
+    }
+
+    return parsed;
+}
+
 bool Parser::parseWinDeclSpec(WinDeclSpecAST *&node)
 {
     if (token_stream.lookAhead() != Token_identifier)
@@ -167,13 +289,15 @@ void Parser::syntaxError()
 
 void Parser::reportError(const QString& msg)
 {
+    ++_M_errors;
+
     if (!_M_block_errors) {
         int line, column;
         QString fileName;
 
         std::size_t tok = token_stream.cursor();
-        location().positionAt(token_stream.position(tok),
-                              &line, &column, &fileName);
+        _M_positions->positionAt(token_stream.position(tok),
+                                 &line, &column, &fileName);
 
         Control::ErrorMessage errmsg;
         errmsg.setLine(line + 1);
@@ -318,6 +442,12 @@ bool Parser::skip(int l, int r)
 }
 
 bool Parser::parseName(NameAST *&node, bool acceptTemplateId)
+{
+    return memoize(acceptTemplateId ? MemoTemplateName : MemoName, node,
+                   &Parser::parseNameInternal, acceptTemplateId);
+}
+
+bool Parser::parseNameInternal(NameAST *&node, bool acceptTemplateId)
 {
     std::size_t start = token_stream.cursor();
 
@@ -351,7 +481,7 @@ bool Parser::parseName(NameAST *&node, bool acceptTemplateId)
         } else {
             Q_ASSERT(n);
             if (!acceptTemplateId) {
-                token_stream.rewind((int) n->start_token);
+                rewind(n->start_token);
                 parseUnqualifiedName(n, false);
             }
 
@@ -374,13 +504,27 @@ bool Parser::parseTranslationUnit(TranslationUnitAST *&node)
     std::size_t start = token_stream.cursor();
     TranslationUnitAST *ast = CreateNode<TranslationUnitAST>(_M_pool);
 
-    while (token_stream.lookAhead()) {
+    if (!_M_parallel || !parseDeclarationsInParallel(ast->declarations))
+        parseDeclarations(ast->declarations, token_stream.end());
+
+    UPDATE_POS(ast, start, token_stream.cursor());
+    node = ast;
+
+    return true;
+}
+
+void Parser::parseDeclarations(const ListNode<DeclarationAST*> *&declarations, std::size_t end)
+{
+    while (token_stream.cursor() < end && token_stream.lookAhead()) {
         std::size_t startDecl = token_stream.cursor();
+        pool::mark_type mark = _M_pool->mark();
 
         DeclarationAST *declaration = 0;
         if (parseDeclaration(declaration)) {
-            ast->declarations =
-                snoc(ast->declarations, declaration, _M_pool);
+            if (_M_consumer)
+                consume(declaration, mark);
+            else
+                declarations = snoc(declarations, declaration, _M_pool);
         } else {
             // error recovery
             if (startDecl == token_stream.cursor()) {
@@ -389,11 +533,171 @@ bool Parser::parseTranslationUnit(TranslationUnitAST *&node)
             }
 
             skipUntilDeclaration();
+
+            if (_M_consumer)
+                consume(0, mark);
         }
     }
+}
 
-    UPDATE_POS(ast, start, token_stream.cursor());
-    node = ast;
+// Hands a top-level declaration over and gives its nodes back to the pool.
+// The parser never goes back before the cursor, but the memo may remember
+// nodes at the tokens after it, tried and given up while parsing it.
+void Parser::consume(DeclarationAST *declaration, const pool::mark_type &mark)
+{
+    if (declaration)
+        _M_consumer->declaration(declaration);
+
+    std::size_t cursor = token_stream.cursor();
+    if (_M_memo_reach >= cursor) {
+        for (int i = 0; i < MemoSize; ++i) {
+            if (_M_memo[i].start >= cursor)
+                _M_memo[i].rule = MemoRuleCount;
+        }
+        _M_memo_reach = 0;
+    }
+
+    _M_pool->reset(mark);
+}
+
+// Parses the top-level declarations from a token on, up to another, for
+// parseDeclarationsInParallel(). The tokens are those of the main parser,
+// the nodes and errors are kept aside until they are merged.
+class DeclarationsTask : public QRunnable
+{
+public:
+    DeclarationsTask(Parser *main, std::size_t begin, std::size_t end)
+            : control(main->control->nameTable()),
+            parser(&control),
+            begin(begin),
+            end(end),
+            stop(0),
+            declarations(0)
+    {
+        setAutoDelete(false);
+
+        control.setSkipFunctionBody(main->control->skipFunctionBody());
+        parser.token_stream.share(main->token_stream);
+        parser._M_positions = main->_M_positions;
+        parser._M_memoizing = main->_M_memoizing;
+        parser.prepare(&memory);
+    }
+
+    void run()
+    {
+        parser.token_stream.rewind((int) begin);
+        parser.parseDeclarations(declarations, end);
+        stop = parser.token_stream.cursor();
+    }
+
+    Control control;
+    Parser parser;
+    pool memory;
+    std::size_t begin;
+    std::size_t end;
+    std::size_t stop;
+    const ListNode<DeclarationAST*> *declarations;
+};
+
+std::vector<std::size_t> Parser::splitDeclarations(std::size_t chunk_size) const
+{
+    std::vector<std::size_t> boundaries;
+    std::size_t next = token_stream.cursor() + chunk_size;
+    int parens = 0;
+
+    for (std::size_t i = token_stream.cursor(); token_stream.kind(i) != Token_EOF; ++i) {
+        switch (token_stream.kind(i)) {
+        case '(':
+            ++parens;
+            break;
+
+        case ')':
+            --parens;
+            break;
+
+        case '{':
+            // namespaces and linkage blocks are kept whole with the rest
+            i = token_stream.matchingBrace(i);
+            if (!i)
+                return boundaries;
+            break;
+
+        case ';':
+            if (!parens && i + 1 >= next && token_stream.kind(i + 1) != Token_EOF) {
+                boundaries.push_back(i + 1);
+                next = i + 1 + chunk_size;
+            }
+            break;
+        }
+    }
+
+    return boundaries;
+}
+
+bool Parser::parseDeclarationsInParallel(const ListNode<DeclarationAST*> *&declarations)
+{
+    std::size_t start = token_stream.cursor();
+    std::size_t tokens = 0;
+    while (token_stream.kind(start + tokens) != Token_EOF)
+        ++tokens;
+
+    // a few chunks a thread balance the load, small ones aren't worth it
+    std::size_t chunk_size = std::max(tokens / (4 * QThread::idealThreadCount()), std::size_t(MinChunkSize));
+    std::vector<std::size_t> boundaries = splitDeclarations(chunk_size);
+    if (boundaries.empty())
+        return false;
+
+    QList<DeclarationsTask*> tasks;
+    for (std::size_t i = 0; i < boundaries.size(); ++i) {
+        std::size_t end = i + 1 < boundaries.size() ? boundaries[i + 1] : start + tokens;
+        tasks << new DeclarationsTask(this, boundaries[i], end);
+    }
+
+    QThreadPool threads;
+    foreach (DeclarationsTask *task, tasks)
+        threads.start(task);
+
+    // the first chunk is parsed here meanwhile
+    parseDeclarations(declarations, boundaries.front());
+    threads.waitForDone();
+
+    // A chunk is parsed the same as serially when the declarations before
+    // end at its first token. Otherwise, after errors or when the chunk
+    // before ran past its end, its tokens are parsed here again.
+    foreach (DeclarationsTask *task, tasks) {
+        if (token_stream.cursor() < task->begin)
+            parseDeclarations(declarations, task->begin);
+
+        if (token_stream.cursor() == task->begin) {
+            if (task->declarations) {
+                const ListNode<DeclarationAST*> *it = task->declarations->toFront(), *end = it;
+                do {
+                    if (!_M_consumer)
+                        declarations = snoc(declarations, it->element, _M_pool);
+                    else if (it->element)
+                        _M_consumer->declaration(it->element);
+                    it = it->next;
+                } while (it != end);
+            }
+
+            foreach (const Control::ErrorMessage &message, task->control.errorMessages())
+                control->reportError(message);
+
+            _M_rewinds += task->parser._M_rewinds;
+            for (int i = 0; i < MemoRuleCount; ++i) {
+                _M_rule_statistics[i].calls += task->parser._M_rule_statistics[i].calls;
+                _M_rule_statistics[i].hits += task->parser._M_rule_statistics[i].hits;
+            }
+
+            // handed over nodes go away with the task
+            if (!_M_consumer)
+                _M_pool->splice(task->memory);
+            token_stream.rewind((int) task->stop);
+        }
+    }
+    qDeleteAll(tasks);
+
+    parseDeclarations(declarations, start + tokens);
 
     return true;
 }
@@ -464,7 +768,7 @@ bool Parser::parseDeclaration(DeclarationAST *&node)
     }
     } // end switch
 
-    token_stream.rewind((int) start);
+    rewind(start);
     return parseDeclarationInternal(node);
 }
 
@@ -916,7 +1220,7 @@ bool Parser::parseSimpleTypeSpecifier(TypeSpecifierAST *&node,
             parseTypeId(ast->type_id);
             if (token_stream.lookAhead() != ')') {
                 ast->type_id = 0;
-                token_stream.rewind((int) saved);
+                rewind(saved);
                 parseUnaryExpression(ast->expression);
             }
             ADVANCE(')', ")");
@@ -924,12 +1228,12 @@ bool Parser::parseSimpleTypeSpecifier(TypeSpecifierAST *&node,
             parseUnaryExpression(ast->expression);
         }
     } else if (onlyIntegral) {
-        token_stream.rewind((int) start);
+        rewind(start);
         return false;
     } else {
         if (!parseName(ast->name, true)) {
             ast->name = 0;
-            token_stream.rewind((int) start);
+            rewind(start);
             return false;
         }
     }
@@ -950,6 +1254,7 @@ bool Parser::parsePtrOperator(PtrOperatorAST *&node)
     }
 
     std::size_t start = token_stream.cursor();
+    Checkpoint attempt = checkpoint();
 
     PtrOperatorAST *ast = CreateNode<PtrOperatorAST>(_M_pool);
 
@@ -963,7 +1268,8 @@ bool Parser::parsePtrOperator(PtrOperatorAST *&node)
     case Token_scope:
     case Token_identifier: {
         if (!parsePtrToMember(ast->mem_ptr)) {
-            token_stream.rewind((int) start);
+            rewind(start);
+            release(attempt);
             return false;
         }
     }
@@ -983,6 +1289,11 @@ bool Parser::parsePtrOperator(PtrOperatorAST *&node)
 }
 
 bool Parser::parseTemplateArgument(TemplateArgumentAST *&node)
+{
+    return memoize(MemoTemplateArgument, node, &Parser::parseTemplateArgumentInternal);
+}
+
+bool Parser::parseTemplateArgumentInternal(TemplateArgumentAST *&node)
 {
     std::size_t start = token_stream.cursor();
 
@@ -991,7 +1302,7 @@ bool Parser::parseTemplateArgument(TemplateArgumentAST *&node)
 
     if (!parseTypeId(typeId) || (token_stream.lookAhead() != ','
                                  && token_stream.lookAhead() != '>')) {
-        token_stream.rewind((int) start);
+        rewind(start);
 
         if (!parseLogicalOrExpression(expr, true))
             return false;
@@ -1016,7 +1327,7 @@ bool Parser::parseTypeSpecifier(TypeSpecifierAST *&node)
 
     TypeSpecifierAST *ast = 0;
     if (!parseElaboratedTypeSpecifier(ast) && !parseSimpleTypeSpecifier(ast)) {
-        token_stream.rewind((int) start);
+        rewind(start);
         return false;
     }
 
@@ -1029,6 +1340,11 @@ bool Parser::parseTypeSpecifier(TypeSpecifierAST *&node)
 }
 
 bool Parser::parseDeclarator(DeclaratorAST *&node)
+{
+    return memoize(MemoDeclarator, node, &Parser::parseDeclaratorInternal);
+}
+
+bool Parser::parseDeclaratorInternal(DeclaratorAST *&node)
 {
     std::size_t start = token_stream.cursor();
 
@@ -1058,7 +1374,7 @@ bool Parser::parseDeclarator(DeclaratorAST *&node)
         } else if (parseName(declId, true)) {
             ast->id = declId;
         } else {
-            token_stream.rewind((int) start);
+            rewind(start);
             return false;
         }
 
@@ -1100,7 +1416,7 @@ bool Parser::parseDeclarator(DeclaratorAST *&node)
         if (ast->sub_declarator
             && !(isVector || tok == '(' || tok == ','
                  || tok == ';' || tok == '=')) {
-            token_stream.rewind((int) start);
+            rewind(start);
             return false;
         }
 
@@ -1110,14 +1426,14 @@ bool Parser::parseDeclarator(DeclaratorAST *&node)
 
             ParameterDeclarationClauseAST *params = 0;
             if (!parseParameterDeclarationClause(params)) {
-                token_stream.rewind((int) index);
+                rewind(index);
                 goto update_pos;
             }
 
             ast->parameter_declaration_clause = params;
 
             if (token_stream.lookAhead() != ')') {
-                token_stream.rewind((int) index);
+                rewind(index);
                 goto update_pos;
             }
 
@@ -1146,6 +1462,11 @@ update_pos:
 }
 
 bool Parser::parseAbstractDeclarator(DeclaratorAST *&node)
+{
+    return memoize(MemoAbstractDeclarator, node, &Parser::parseAbstractDeclaratorInternal);
+}
+
+bool Parser::parseAbstractDeclaratorInternal(DeclaratorAST *&node)
 {
     std::size_t start = token_stream.cursor();
 
@@ -1161,14 +1482,14 @@ bool Parser::parseAbstractDeclarator(DeclaratorAST *&node)
         token_stream.nextToken();
 
         if (!parseAbstractDeclarator(decl)) {
-            token_stream.rewind((int) index);
+            rewind(index);
             goto label1;
         }
 
         ast->sub_declarator = decl;
 
         if (token_stream.lookAhead() != ')') {
-            token_stream.rewind((int) start);
+            rewind(start);
             return false;
         }
         token_stream.nextToken();
@@ -1200,7 +1521,7 @@ label1: {
         if (ast->sub_declarator
             && !(isVector || tok == '(' || tok == ','
                  || tok == ';' || tok == '=')) {
-            token_stream.rewind((int) start);
+            rewind(start);
             return false;
         }
 
@@ -1210,14 +1531,14 @@ label1: {
 
             ParameterDeclarationClauseAST *params = 0;
             if (!parseParameterDeclarationClause(params)) {
-                token_stream.rewind((int) index);
+                rewind(index);
                 goto update_pos;
             }
 
             ast->parameter_declaration_clause = params;
 
             if (token_stream.lookAhead() != ')') {
-                token_stream.rewind((int) index);
+                rewind(index);
                 goto update_pos;
             }
 
@@ -1248,7 +1569,7 @@ bool Parser::parseEnumSpecifier(TypeSpecifierAST *&node)
     parseName(name);
 
     if (token_stream.lookAhead() != '{') {
-        token_stream.rewind((int) start);
+        rewind(start);
         return false;
     }
     token_stream.nextToken();
@@ -1340,12 +1661,12 @@ bool Parser::parseTypeParameter(TypeParameterAST *&node)
 
                 if (!parseTypeId(ast->type_id)) {
                     //syntaxError();
-                    token_stream.rewind((int) start);
+                    rewind(start);
                     return false;
                 }
             } else if (token_stream.lookAhead() != ','
                        && token_stream.lookAhead() != '>') {
-                token_stream.rewind((int) start);
+                rewind(start);
                 return false;
             }
         }
@@ -1427,13 +1748,18 @@ bool Parser::parseFunctionSpecifier(const ListNode<std::size_t> *&node)
 }
 
 bool Parser::parseTypeId(TypeIdAST *&node)
+{
+    return memoize(MemoTypeId, node, &Parser::parseTypeIdInternal);
+}
+
+bool Parser::parseTypeIdInternal(TypeIdAST *&node)
 {
     /// @todo implement the AST for typeId
     std::size_t start = token_stream.cursor();
 
     TypeSpecifierAST *spec = 0;
     if (!parseTypeSpecifier(spec)) {
-        token_stream.rewind((int) start);
+        rewind(start);
         return false;
     }
 
@@ -1511,7 +1837,7 @@ bool Parser::parseParameterDeclarationList(const ListNode<ParameterDeclarationAS
 
     ParameterDeclarationAST *param = 0;
     if (!parseParameterDeclaration(param)) {
-        token_stream.rewind((int) start);
+        rewind(start);
         return false;
     }
 
@@ -1524,7 +1850,7 @@ bool Parser::parseParameterDeclarationList(const ListNode<ParameterDeclarationAS
             break;
 
         if (!parseParameterDeclaration(param)) {
-            token_stream.rewind((int) start);
+            rewind(start);
             return false;
         }
         node = snoc(node, param, _M_pool);
@@ -1534,6 +1860,11 @@ bool Parser::parseParameterDeclarationList(const ListNode<ParameterDeclarationAS
 }
 
 bool Parser::parseParameterDeclaration(ParameterDeclarationAST *&node)
+{
+    return memoize(MemoParameterDeclaration, node, &Parser::parseParameterDeclarationInternal);
+}
+
+bool Parser::parseParameterDeclarationInternal(ParameterDeclarationAST *&node)
 {
     std::size_t start = token_stream.cursor();
 
@@ -1543,7 +1874,7 @@ bool Parser::parseParameterDeclaration(ParameterDeclarationAST *&node)
     // parse decl spec
     TypeSpecifierAST *spec = 0;
     if (!parseTypeSpecifier(spec)) {
-        token_stream.rewind((int) start);
+        rewind(start);
         return false;
     }
 
@@ -1551,7 +1882,7 @@ bool Parser::parseParameterDeclaration(ParameterDeclarationAST *&node)
 
     DeclaratorAST *decl = 0;
     if (!parseDeclarator(decl)) {
-        token_stream.rewind((int) index);
+        rewind(index);
 
         // try with abstract declarator
         parseAbstractDeclarator(decl);
@@ -1621,20 +1952,20 @@ bool Parser::parseForwardDeclarationSpecifier(TypeSpecifierAST *&node)
 
     NameAST *name = 0;
     if (!parseName(name, false)) {
-        token_stream.rewind((int) start);
+        rewind(start);
         return false;
     }
 
     BaseClauseAST *bases = 0;
     if (token_stream.lookAhead() == ':') {
         if (!parseBaseClause(bases)) {
-            token_stream.rewind((int) start);
+            rewind(start);
             return false;
         }
     }
 
     if (token_stream.lookAhead() != ';') {
-        token_stream.rewind((int) start);
+        rewind(start);
         return false;
     }
 
@@ -1682,7 +2013,7 @@ bool Parser::parseClassSpecifier(TypeSpecifierAST *&node)
 
     if (token_stream.lookAhead() != '{') {
 
-        token_stream.rewind((int) start);
+        rewind(start);
         return false;
     }
 
@@ -1781,7 +2112,7 @@ bool Parser::parseMemberSpecification(DeclarationAST *&node)
         return true;
     }
 
-    token_stream.rewind((int) start);
+    rewind(start);
 
     const ListNode<std::size_t> *cv = 0;
     parseCvQualify(cv);
@@ -1809,7 +2140,7 @@ bool Parser::parseMemberSpecification(DeclarationAST *&node)
         return true;
     }
 
-    token_stream.rewind((int) start);
+    rewind(start);
     return parseDeclarationInternal(node);
 }
 
@@ -1859,7 +2190,7 @@ bool Parser::parseElaboratedTypeSpecifier(TypeSpecifierAST *&node)
         }
     }
 
-    token_stream.rewind((int) start);
+    rewind(start);
     return false;
 }
 
@@ -2158,7 +2489,7 @@ bool Parser::parsePtrToMember(PtrToMemberAST *&node)
             token_stream.nextToken();
     }
 
-    token_stream.rewind((int) start);
+    rewind(start);
     return false;
 }
 
@@ -2206,7 +2537,7 @@ bool Parser::parseUnqualifiedName(UnqualifiedNameAST *&node,
                 token_stream.nextToken();
             } else {
                 ast->template_arguments = 0;
-                token_stream.rewind((int) index);
+                rewind(index);
             }
         }
     }
@@ -2339,7 +2670,7 @@ bool Parser::parseExpressionOrDeclarationStatement(StatementAST *&node)
 
     std::size_t end = token_stream.cursor();
 
-    token_stream.rewind((int) start);
+    rewind(start);
     StatementAST *expr_ast = 0;
     maybe_amb &= parseExpressionStatement(expr_ast);
     maybe_amb &= token_stream.kind(token_stream.cursor() - 1) == ';';
@@ -2354,7 +2685,7 @@ bool Parser::parseExpressionOrDeclarationStatement(StatementAST *&node)
         UPDATE_POS(ast, start, token_stream.cursor());
         node = ast;
     } else {
-        token_stream.rewind((int) std::max(end, token_stream.cursor()));
+        rewind(std::max(end, token_stream.cursor()));
 
         node = decl_ast;
         if (!node)
@@ -2383,7 +2714,7 @@ bool Parser::parseCondition(ConditionAST *&node, bool initRequired)
 
         DeclaratorAST *decl = 0;
         if (!parseDeclarator(decl)) {
-            token_stream.rewind((int) declarator_start);
+            rewind(declarator_start);
             if (!initRequired && !parseAbstractDeclarator(decl))
                 decl = 0;
         }
@@ -2404,7 +2735,7 @@ bool Parser::parseCondition(ConditionAST *&node, bool initRequired)
         }
     }
 
-    token_stream.rewind((int) start);
+    rewind(start);
 
     if (!parseCommaExpression(ast->expression))
         return false;
@@ -2698,7 +3029,7 @@ bool Parser::parseBlockDeclaration(DeclarationAST *&node)
 
     TypeSpecifierAST *spec = 0;
     if (!parseTypeSpecifierOrClassSpec(spec)) { // replace with simpleTypeSpecifier?!?!
-        token_stream.rewind((int) start);
+        rewind(start);
         return false;
     }
 
@@ -2709,7 +3040,7 @@ bool Parser::parseBlockDeclaration(DeclarationAST *&node)
     parseInitDeclaratorList(declarators);
 
     if (token_stream.lookAhead() != ';') {
-        token_stream.rewind((int) start);
+        rewind(start);
         return false;
     }
     token_stream.nextToken();
@@ -2798,7 +3129,7 @@ bool Parser::parseDeclarationInternal(DeclarationAST *&node)
     if (parseName(name, true) && token_stream.lookAhead() == '(') {
         // no type specifier, maybe a constructor or a cast operator??
 
-        token_stream.rewind((int) index);
+        rewind(index);
 
         InitDeclaratorAST *declarator = 0;
         if (parseInitDeclarator(declarator)) {
@@ -2871,7 +3202,7 @@ bool Parser::parseDeclarationInternal(DeclarationAST *&node)
     }
 
 start_decl:
-    token_stream.rewind((int) index);
+    rewind(index);
 
     if (token_stream.lookAhead() == Token_const
         && token_stream.lookAhead(1) == Token_identifier
@@ -2918,7 +3249,7 @@ start_decl:
                 // function definition
                 maybeFunctionDefinition = true;
             } else {
-                token_stream.rewind((int) startDeclarator);
+                rewind(startDeclarator);
                 if (!parseInitDeclaratorList(declarators)) {
                     syntaxError();
                     return false;
@@ -2975,13 +3306,26 @@ start_decl:
     return false;
 }
 
-bool Parser::skipFunctionBody(StatementAST *&)
+bool Parser::skipFunctionBody(StatementAST *&node)
 {
-#if defined(__GNUC__)
-#warning "Parser::skipFunctionBody() -- implement me"
-#endif
-    Q_ASSERT(0); // ### not implemented
-    return 0;
+    std::size_t start = token_stream.cursor();
+
+    CHECK('{');
+
+    // the lexer matched the braces, an unbalanced body is parsed instead
+    std::size_t end = token_stream.matchingBrace(start);
+    if (!end) {
+        rewind(start);
+        return parseCompoundStatement(node);
+    }
+
+    rewind(end + 1);
+
+    CompoundStatementAST *ast = CreateNode<CompoundStatementAST>(_M_pool);
+    UPDATE_POS(ast, start, token_stream.cursor());
+    node = ast;
+
+    return true;
 }
 
 bool Parser::parseFunctionBody(StatementAST *&node)
@@ -3157,7 +3501,7 @@ bool Parser::parsePostfixExpressionInternal(ExpressionAST *&node)
             // a template method call
             // ### reverse the logic
         } else {
-            token_stream.rewind(saved);
+            rewind(saved);
             name = 0;
 
             if (!parseName(name, templ != 0))
@@ -3289,14 +3633,14 @@ bool Parser::parsePostfixExpression(ExpressionAST *&node)
             ExpressionAST *cast_expr = 0;
             if (parseCastExpression(cast_expr)
                 && cast_expr->kind == AST::Kind_CastExpression) {
-                token_stream.rewind((int) saved_pos);
+                rewind(saved_pos);
                 parsePrimaryExpression(expr);
                 goto L_no_rewind;
             }
         }
     }
 
-    token_stream.rewind((int) saved_pos);
+    rewind(saved_pos);
 
 L_no_rewind:
     if (!expr && parseSimpleTypeSpecifier(typeSpec)
@@ -3308,7 +3652,7 @@ L_no_rewind:
         typeSpec = 0;
     } else {
         typeSpec = 0;
-        token_stream.rewind((int) start);
+        rewind(start);
 
         if (!parsePrimaryExpression(expr))
             return false;
@@ -3382,7 +3726,7 @@ bool Parser::parseUnaryExpression(ExpressionAST *&node)
             }
 
             ast->type_id = 0;
-            token_stream.rewind((int) index);
+            rewind(index);
         }
 
         if (!parseUnaryExpression(ast->expression))
@@ -3564,7 +3908,7 @@ bool Parser::parseCastExpression(ExpressionAST *&node)
         }
     }
 
-    token_stream.rewind((int) start);
+    rewind(start);
     return parseUnaryExpression(node);
 }
 
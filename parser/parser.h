@@ -31,9 +31,24 @@
 
 #include <QtCore/QString>
 
+#include <vector>
+
 class FileSymbol;
 class Control;
 
+/**
+*   Takes the top-level declarations from the parser one at a time, as
+*   soon as each is parsed. The nodes are given back to the pool after
+*   declaration() returns, so nothing may keep pointers to them.
+*/
+class DeclarationConsumer
+{
+public:
+    virtual ~DeclarationConsumer() {}
+
+    virtual void declaration(DeclarationAST *node) = 0;
+};
+
 class Parser
 {
 public:
@@ -44,6 +59,69 @@ public:
 
     TranslationUnitAST *parse(const char *contents, std::size_t size, pool *p);
 
+    /**
+    *   Lexes the text written through the sink while it is being written,
+    *   parse() must then be called with the complete \a buffer.
+    */
+    LexerSink sink(std::string &buffer) { return LexerSink(&lexer, &buffer); }
+
+    /**
+    *   The rules that backtracking retries most, at tokens where they were
+    *   tried already. Their results are remembered by rule and start token,
+    *   so a retry reuses the nodes and the end of the first attempt.
+    */
+    enum MemoRule {
+        MemoName,
+        MemoTemplateName,
+        MemoDeclarator,
+        MemoAbstractDeclarator,
+        MemoTypeId,
+        MemoTemplateArgument,
+        MemoParameterDeclaration,
+        MemoRuleCount
+    };
+
+    struct RuleStatistics {
+        std::size_t calls;
+        std::size_t hits;
+    };
+
+    static const char *ruleName(MemoRule rule);
+
+    /**
+    *   Memoizing is on by default, turning it off makes every retry parse
+    *   its tokens again. The statistics are kept either way, and are reset
+    *   by parse().
+    */
+    void setMemoizing(bool memoizing) { _M_memoizing = memoizing; }
+    bool isMemoizing() const { return _M_memoizing; }
+
+    const RuleStatistics &ruleStatistics(MemoRule rule) const { return _M_rule_statistics[rule]; }
+
+    /// how many times the parser went back in the token stream
+    std::size_t rewinds() const { return _M_rewinds; }
+
+    /**
+    *   Parses the top-level declarations on a thread pool. The tokens are
+    *   split after top-level ';', never inside braces, in chunks parsed
+    *   by parsers of their own, whose declarations and errors are then
+    *   merged in order. The tree is the one parsed serially: a
+    *   chunk that doesn't start where the declarations before it end is
+    *   parsed again. Off by default.
+    */
+    void setParallel(bool parallel) { _M_parallel = parallel; }
+    bool isParallel() const { return _M_parallel; }
+
+    /**
+    *   Hands the top-level declarations to \a consumer instead of keeping
+    *   them in the translation unit, whose declarations are then empty.
+    *   The pool only holds the declaration being parsed, not the tree of
+    *   the whole translation unit; in parallel mode, it holds the trees
+    *   of the chunks until they are handed over.
+    */
+    void setDeclarationConsumer(DeclarationConsumer *consumer) { _M_consumer = consumer; }
+    DeclarationConsumer *declarationConsumer() const { return _M_consumer; }
+
 private:
     void reportError(const QString& msg);
     void syntaxError();
@@ -182,11 +260,84 @@ public:
 private:
     QString tokenText(AST *) const;
 
+    void prepare(pool *p);
+
+    void parseDeclarations(const ListNode<DeclarationAST*> *&declarations, std::size_t end);
+    bool parseDeclarationsInParallel(const ListNode<DeclarationAST*> *&declarations);
+    std::vector<std::size_t> splitDeclarations(std::size_t chunk_size) const;
+    void consume(DeclarationAST *declaration, const pool::mark_type &mark);
+
+    // the fewest tokens worth a chunk
+    enum { MinChunkSize = 1 << 14 };
+
+    inline void rewind(std::size_t index) {
+        ++_M_rewinds;
+        token_stream.rewind((int) index);
+    }
+
+    bool parseNameInternal(NameAST *&node, bool acceptTemplateId);
+    bool parseDeclaratorInternal(DeclaratorAST *&node);
+    bool parseAbstractDeclaratorInternal(DeclaratorAST *&node);
+    bool parseTypeIdInternal(TypeIdAST *&node);
+    bool parseTemplateArgumentInternal(TemplateArgumentAST *&node);
+    bool parseParameterDeclarationInternal(ParameterDeclarationAST *&node);
+
+    struct Checkpoint {
+        pool::mark_type mark;
+        std::size_t remembered;
+    };
+
+    inline Checkpoint checkpoint() const {
+        Checkpoint checkpoint;
+        checkpoint.mark = _M_pool->mark();
+        checkpoint.remembered = _M_remembered;
+        return checkpoint;
+    }
+
+    /**
+    *   Gives the nodes allocated since the checkpoint back to the pool,
+    *   after an attempt that failed. Nothing refers to them unless the
+    *   memo remembered some, and then they are kept.
+    */
+    inline void release(const Checkpoint &checkpoint) {
+        if (_M_remembered == checkpoint.remembered)
+            _M_pool->reset(checkpoint.mark);
+    }
+
+    struct MemoEntry {
+        std::size_t start;
+        std::size_t end;
+        AST *node;
+        int rule;
+        bool parsed;
+    };
+
+    // a direct-mapped cache, backtracking only goes back a few tokens
+    enum { MemoSize = 1 << 12 };
+
+    template <class Node>
+    bool memoize(MemoRule rule, Node *&node, bool (Parser::*parse)(Node *&));
+    template <class Node, class Arg>
+    bool memoize(MemoRule rule, Node *&node, bool (Parser::*parse)(Node *&, Arg), Arg arg);
+    MemoEntry *memoEntry(MemoRule rule);
+
     LocationManager _M_location;
     Control *control;
     Lexer lexer;
+    LocationManager *_M_positions;
     pool *_M_pool;
     bool _M_block_errors;
+    std::size_t _M_errors;
+    std::size_t _M_rewinds;
+    std::size_t _M_remembered;
+    std::size_t _M_memo_reach;
+    bool _M_memoizing;
+    bool _M_parallel;
+    DeclarationConsumer *_M_consumer;
+    MemoEntry *_M_memo;
+    RuleStatistics _M_rule_statistics[MemoRuleCount];
+
+    friend class DeclarationsTask;
 
 private:
     Parser(const Parser& source);
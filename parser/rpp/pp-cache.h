@@ -0,0 +1,735 @@
+/*
+ * This file is part of the API Extractor project.
+ *
+ * Copyright (C) 2009 Nokia Corporation and/or its subsidiary(-ies).
+ *
+ * Contact: PySide team <contact@pyside.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+
+#ifndef PP_CACHE_H
+#define PP_CACHE_H
+
+#include <set>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdio>
+
+#include <sys/stat.h>
+
+#include "pp-environment.h"
+
+namespace rpp
+{
+
+typedef unsigned long long pp_cache_hash;
+
+/* The result of preprocessing one file: the expanded text, the macro
+ * definitions and removals it performed and everything it depends on.
+ * An entry can be replayed in place of the file whenever each macro it
+ * looked up still has the same definition (or is still undefined), each
+ * file it included still has the same contents and each #include still
+ * resolves to the same file.
+ *
+ * The text is only the file's own, the output of an included file is
+ * referred to by the entry it was recorded in or replayed from.
+ */
+struct pp_cache_entry {
+    struct macro_dependency {
+        std::string name;
+        std::string fingerprint;
+    };
+
+    struct file_dependency {
+        std::string path;
+        pp_cache_hash hash;
+        long long size;
+        long long mtime;
+    };
+
+    // where an #include was found, and the candidates before it that
+    // didn't exist; the include paths are part of the cache context
+    struct include_dependency {
+        std::string name;
+        int policy;
+        bool skip_current_path;
+        std::string directory;
+        std::string path;   // empty if it wasn't found
+        std::vector<std::string> missing;
+    };
+
+    // the output of an included file, at offset in the text of this one
+    struct child_output {
+        std::size_t offset;
+        pp_cache_hash key;
+        pp_cache_hash id;
+    };
+
+    struct macro_event {
+        bool bind;
+        std::string name;
+        std::string definition;
+        std::vector<std::string> formals;
+        bool function_like;
+        bool variadics;
+        int lines;
+    };
+
+    std::vector<macro_dependency> macros;
+    std::vector<file_dependency> files;
+    std::vector<include_dependency> includes;
+    std::vector<macro_event> events;
+    std::vector<child_output> children;
+    std::string output;
+    pp_cache_hash id;   // the same for entries that replay the same way, see pp_cache::identify()
+
+    pp_cache_entry(): id(0) {}
+};
+
+/* Records a pp_cache_entry while a file is being preprocessed. Recorders
+ * nest the same way includes do, a finished recorder hands what it
+ * collected over to the recorder of the including file.
+ */
+class pp_cache_recorder: public pp_macro_observer
+{
+public:
+    // __output is where the file is being preprocessed to
+    pp_cache_recorder(pp_environment &__env, pp_cache_recorder *__parent, std::string const &__output):
+            env(__env), _M_parent(__parent), _M_observer(__env.observer()), _M_output(__output) {
+        env.set_observer(this);
+    }
+
+    ~pp_cache_recorder() {
+        env.set_observer(_M_observer);
+    }
+
+    inline pp_cache_recorder *parent() const {
+        return _M_parent;
+    }
+
+    inline pp_cache_entry const &entry() const {
+        return _M_entry;
+    }
+
+    // keeps what is left of the output once the output of the included
+    // files is taken out
+    void finish() {
+        std::size_t __pos = 0;
+        for (std::size_t i = 0; i < _M_entry.children.size(); ++i) {
+            std::size_t __begin = _M_entry.children[i].offset;
+            _M_entry.output.append(_M_output, __pos, __begin - __pos);
+            _M_entry.children[i].offset = _M_entry.output.size();
+            __pos = __begin + _M_child_sizes[i];
+        }
+        _M_entry.output.append(_M_output, __pos, std::string::npos);
+    }
+
+    virtual void macro_resolved(pp_fast_string const &__name, pp_macro const *__macro) {
+        std::string __tmp(__name.begin(), __name.end());
+        add_macro_dependency(__tmp, fingerprint(__macro));
+    }
+
+    virtual void macro_bound(pp_macro const &__macro) {
+        pp_cache_entry::macro_event __event;
+        __event.bind = true;
+        __event.name.assign(__macro.name->begin(), __macro.name->end());
+        if (__macro.definition)
+            __event.definition.assign(__macro.definition->begin(), __macro.definition->end());
+        for (std::size_t i = 0; i < __macro.formals.size(); ++i)
+            __event.formals.push_back(std::string(__macro.formals[i]->begin(), __macro.formals[i]->end()));
+        __event.function_like = __macro.function_like;
+        __event.variadics = __macro.variadics;
+        __event.lines = __macro.lines;
+        add_event(__event);
+    }
+
+    virtual void macro_unbound(pp_fast_string const &__name) {
+        pp_cache_entry::macro_event __event;
+        __event.bind = false;
+        __event.name.assign(__name.begin(), __name.end());
+        __event.function_like = false;
+        __event.variadics = false;
+        __event.lines = 0;
+        add_event(__event);
+    }
+
+    void add_file_dependency(pp_cache_entry::file_dependency const &__file) {
+        _M_entry.files.push_back(__file);
+    }
+
+    void add_include_dependency(pp_cache_entry::include_dependency const &__include) {
+        std::string __key = __include.name;
+        __key += '\0';
+        __key += char('0' + __include.policy);
+        __key += __include.skip_current_path ? '1' : '0';
+        __key += __include.directory;
+        if (_M_includes.insert(__key).second)
+            _M_entry.includes.push_back(__include);
+    }
+
+    // the output of an included file, __size bytes, is about to be written
+    void add_child_output(pp_cache_hash __key, pp_cache_hash __id, std::size_t __size) {
+        pp_cache_entry::child_output __child;
+        __child.offset = _M_output.size();
+        __child.key = __key;
+        __child.id = __id;
+        _M_entry.children.push_back(__child);
+        _M_child_sizes.push_back(__size);
+    }
+
+    // merges the entry of an included file, as if its macro lookups and
+    // definitions had been made by this file
+    void absorb(pp_cache_entry const &__entry) {
+        for (std::size_t i = 0; i < __entry.macros.size(); ++i)
+            add_macro_dependency(__entry.macros[i].name, __entry.macros[i].fingerprint);
+
+        _M_entry.files.insert(_M_entry.files.end(), __entry.files.begin(), __entry.files.end());
+
+        for (std::size_t i = 0; i < __entry.includes.size(); ++i)
+            add_include_dependency(__entry.includes[i]);
+
+        for (std::size_t i = 0; i < __entry.events.size(); ++i)
+            add_event(__entry.events[i]);
+    }
+
+    static std::string fingerprint(pp_macro const *__macro) {
+        if (! __macro)
+            return std::string(1, 'U');
+
+        std::string __f(1, 'D');
+        if (__macro->function_like) {
+            __f += '(';
+            for (std::size_t i = 0; i < __macro->formals.size(); ++i) {
+                if (i)
+                    __f += ',';
+                __f.append(__macro->formals[i]->begin(), __macro->formals[i]->end());
+            }
+            if (__macro->variadics)
+                __f += "...";
+            __f += ')';
+        }
+        __f += ' ';
+        if (__macro->definition)
+            __f.append(__macro->definition->begin(), __macro->definition->end());
+        return __f;
+    }
+
+private:
+    void add_macro_dependency(std::string const &__name, std::string const &__fingerprint) {
+        // only the state before the first touch of a name is an input
+        if (! _M_touched.insert(__name).second)
+            return;
+
+        pp_cache_entry::macro_dependency __dep;
+        __dep.name = __name;
+        __dep.fingerprint = __fingerprint;
+        _M_entry.macros.push_back(__dep);
+    }
+
+    void add_event(pp_cache_entry::macro_event const &__event) {
+        _M_touched.insert(__event.name);
+        _M_entry.events.push_back(__event);
+    }
+
+private:
+    pp_environment &env;
+    pp_cache_recorder *_M_parent;
+    pp_macro_observer *_M_observer;
+    std::string const &_M_output;
+    pp_cache_entry _M_entry;
+    std::vector<std::size_t> _M_child_sizes;
+    std::set<std::string> _M_touched;
+    std::set<std::string> _M_includes;
+
+private:
+    pp_cache_recorder(pp_cache_recorder const &);
+    void operator = (pp_cache_recorder const &);
+};
+
+/* Persistent, content addressed store of preprocessed files. Entries are
+ * kept in one file per (path, contents, context) key inside the cache
+ * directory, each key holding a few variants for different incoming macro
+ * states. The context should describe everything else the preprocessor
+ * output depends on, e.g. the include paths.
+ *
+ * An entry refers to the entries of the files it included by key and id,
+ * a variant that was dropped to make room makes the entries that refer to
+ * it miss.
+ */
+class pp_cache
+{
+public:
+    enum { MAX_VARIANTS = 8, MAX_STRING_SIZE = 1 << 30, FORMAT_VERSION = 2 };
+
+    explicit pp_cache(std::string const &__directory):
+            _M_directory(__directory), _M_context(0), _M_hits(0), _M_misses(0) {
+        if (! _M_directory.empty() && _M_directory[_M_directory.size() - 1] != PATH_SEPARATOR)
+            _M_directory += PATH_SEPARATOR;
+    }
+
+    inline std::string const &directory() const {
+        return _M_directory;
+    }
+
+    inline void set_context(std::string const &__context) {
+        _M_context = hash(__context.c_str(), __context.size());
+    }
+
+    inline int hits() const {
+        return _M_hits;
+    }
+
+    inline int misses() const {
+        return _M_misses;
+    }
+
+    static pp_cache_hash hash(char const *__data, std::size_t __size,
+                              pp_cache_hash __h = 14695981039346656037ULL) {
+        for (std::size_t i = 0; i < __size; ++i) {
+            __h ^= (unsigned char) __data[i];
+            __h *= 1099511628211ULL;
+        }
+        return __h;
+    }
+
+    static bool stat_file(std::string const &__path, long long *__size, long long *__mtime) {
+        struct stat __st;
+        if (stat(__path.c_str(), &__st) != 0)
+            return false;
+
+        *__size = __st.st_size;
+        *__mtime = __st.st_mtime;
+        return true;
+    }
+
+    static bool file_exists(std::string const &__path) {
+        struct stat __st;
+        return stat(__path.c_str(), &__st) == 0 && (__st.st_mode & S_IFMT) != S_IFDIR;
+    }
+
+    static bool read_file(std::string const &__path, std::string *__contents) {
+        FILE *fp = std::fopen(__path.c_str(), "rb");
+        if (! fp)
+            return false;
+
+        read_file(fp, __contents);
+        return true;
+    }
+
+    static void read_file(FILE *fp, std::string *__contents) {
+        char tmp[4096];
+        std::size_t read;
+        while ((read = fread(tmp, sizeof(char), sizeof(tmp), fp)) > 0)
+            __contents->append(tmp, read);
+        fclose(fp);
+    }
+
+    pp_cache_entry::file_dependency file_dependency(std::string const &__path,
+                                                    std::string const &__contents) const {
+        pp_cache_entry::file_dependency __file;
+        __file.path = __path;
+        __file.hash = hash(__contents.c_str(), __contents.size());
+        __file.size = __file.mtime = -1;
+        stat_file(__path, &__file.size, &__file.mtime);
+        return __file;
+    }
+
+    // the key of the variants of a file, the same as long as its path,
+    // its contents and the context are
+    pp_cache_hash key(std::string const &__path, std::string const &__contents) const {
+        pp_cache_hash __h = hash(__contents.c_str(), __contents.size());
+        __h = hash(__path.c_str(), __path.size(), __h);
+        __h += FORMAT_VERSION;
+        return __h ^ _M_context;
+    }
+
+    // finds a variant that is valid for the macros in __env and puts its
+    // output, with the output of the files it included, in __output
+    bool lookup(pp_cache_hash __key, pp_environment &__env,
+                pp_cache_entry *__entry, std::string *__output) {
+        std::vector<pp_cache_entry> __variants;
+        load(file_name(__key), &__variants);
+
+        pp_macro_observer *__observer = __env.observer();
+        __env.set_observer(0);
+
+        bool __found = false;
+        for (std::size_t i = 0; ! __found && i < __variants.size(); ++i) {
+            if (is_valid(__variants[i], __env)) {
+                __output->clear();
+                __found = expand(__variants[i], __output);
+                if (__found)
+                    *__entry = __variants[i];
+            }
+        }
+
+        __env.set_observer(__observer);
+
+        if (__found)
+            ++_M_hits;
+        else
+            ++_M_misses;
+
+        return __found;
+    }
+
+    // returns the id the entry is stored with
+    pp_cache_hash store(pp_cache_hash __key, pp_cache_entry const &__entry) {
+        std::string __file_name = file_name(__key);
+
+        std::vector<pp_cache_entry> __variants;
+        load(__file_name, &__variants);
+
+        if (__variants.size() >= MAX_VARIANTS)
+            __variants.erase(__variants.begin());
+        __variants.push_back(__entry);
+        __variants.back().id = identify(__entry);
+
+        save(__file_name, __variants);
+        return __variants.back().id;
+    }
+
+    // entries with the same text, included files and macro events replay
+    // the same way, whatever they depend on
+    static pp_cache_hash identify(pp_cache_entry const &__entry) {
+        pp_cache_hash __h = hash(__entry.output.c_str(), __entry.output.size());
+        for (std::size_t i = 0; i < __entry.children.size(); ++i) {
+            __h = hash_number(__entry.children[i].offset, __h);
+            __h = hash_number(__entry.children[i].key, __h);
+            __h = hash_number(__entry.children[i].id, __h);
+        }
+
+        for (std::size_t i = 0; i < __entry.events.size(); ++i) {
+            pp_cache_entry::macro_event const &__event = __entry.events[i];
+            __h = hash_number(__event.bind, __h);
+            __h = hash_string(__event.name, __h);
+            __h = hash_string(__event.definition, __h);
+            __h = hash_number(__event.formals.size(), __h);
+            for (std::size_t j = 0; j < __event.formals.size(); ++j)
+                __h = hash_string(__event.formals[j], __h);
+            __h = hash_number(__event.function_like, __h);
+            __h = hash_number(__event.variadics, __h);
+            __h = hash_number((pp_cache_hash) __event.lines, __h);
+        }
+        return __h;
+    }
+
+    // applies the macro definitions and removals of a cached file
+    static void replay(pp_cache_entry const &__entry, pp_environment &__env) {
+        pp_macro_observer *__observer = __env.observer();
+        __env.set_observer(0);
+
+        for (std::size_t i = 0; i < __entry.events.size(); ++i) {
+            pp_cache_entry::macro_event const &__event = __entry.events[i];
+            pp_fast_string const *__name = __env.symbols().get(__event.name);
+
+            if (! __event.bind) {
+                __env.unbind(__name);
+                continue;
+            }
+
+            pp_macro __macro;
+            __macro.definition = __env.symbols().get(__event.definition);
+            for (std::size_t j = 0; j < __event.formals.size(); ++j)
+                __macro.formals.push_back(__env.symbols().get(__event.formals[j]));
+            __macro.function_like = __event.function_like;
+            __macro.variadics = __event.variadics;
+            __macro.lines = __event.lines;
+            __env.bind(__name, __macro);
+        }
+
+        __env.set_observer(__observer);
+    }
+
+private:
+    bool is_valid(pp_cache_entry const &__entry, pp_environment &__env) const {
+        for (std::size_t i = 0; i < __entry.macros.size(); ++i) {
+            pp_cache_entry::macro_dependency const &__dep = __entry.macros[i];
+            pp_macro const *__macro = __env.resolve(__dep.name.c_str(), __dep.name.size());
+            if (pp_cache_recorder::fingerprint(__macro) != __dep.fingerprint)
+                return false;
+        }
+
+        for (std::size_t i = 0; i < __entry.files.size(); ++i) {
+            pp_cache_entry::file_dependency const &__file = __entry.files[i];
+
+            long long __size, __mtime;
+            if (! stat_file(__file.path, &__size, &__mtime))
+                return false;
+
+            if (__size == __file.size && __mtime == __file.mtime)
+                continue;
+
+            std::string __contents;
+            if (! read_file(__file.path, &__contents)
+                || hash(__contents.c_str(), __contents.size()) != __file.hash)
+                return false;
+        }
+
+        // a header that appeared earlier on the include path, or one that
+        // was missing, changes what is included
+        for (std::size_t i = 0; i < __entry.includes.size(); ++i) {
+            pp_cache_entry::include_dependency const &__include = __entry.includes[i];
+            if (! __include.path.empty() && ! file_exists(__include.path))
+                return false;
+
+            for (std::size_t j = 0; j < __include.missing.size(); ++j) {
+                if (file_exists(__include.missing[j]))
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
+    // puts the text of __entry, with the output of the included files
+    // in place, in __output
+    bool expand(pp_cache_entry const &__entry, std::string *__output) const {
+        std::size_t __pos = 0;
+        for (std::size_t i = 0; i < __entry.children.size(); ++i) {
+            pp_cache_entry::child_output const &__child = __entry.children[i];
+            __output->append(__entry.output, __pos, __child.offset - __pos);
+            __pos = __child.offset;
+
+            std::vector<pp_cache_entry> __variants;
+            load(file_name(__child.key), &__variants);
+
+            std::size_t j = 0;
+            while (j < __variants.size() && __variants[j].id != __child.id)
+                ++j;
+            if (j == __variants.size() || ! expand(__variants[j], __output))
+                return false;
+        }
+        __output->append(__entry.output, __pos, std::string::npos);
+        return true;
+    }
+
+    std::string file_name(pp_cache_hash __key) const {
+        char __buffer[32];
+        pp_snprintf(__buffer, sizeof(__buffer), "%016llx.ppc", __key);
+        return _M_directory + __buffer;
+    }
+
+    // on disk format: a sequence of length prefixed records, see save()
+    void load(std::string const &__file_name, std::vector<pp_cache_entry> *__variants) const {
+        std::ifstream __in(__file_name.c_str(), std::ios::in | std::ios::binary);
+        if (! __in)
+            return;
+
+        std::size_t __count = read_number(__in);
+        for (std::size_t i = 0; __in && i < __count; ++i) {
+            pp_cache_entry __entry;
+
+            std::size_t __n = read_number(__in);
+            for (std::size_t j = 0; __in && j < __n; ++j) {
+                pp_cache_entry::macro_dependency __dep;
+                __dep.name = read_string(__in);
+                __dep.fingerprint = read_string(__in);
+                __entry.macros.push_back(__dep);
+            }
+
+            __n = read_number(__in);
+            for (std::size_t j = 0; __in && j < __n; ++j) {
+                pp_cache_entry::file_dependency __file;
+                __file.path = read_string(__in);
+                __file.hash = read_number(__in);
+                __file.size = (long long) read_number(__in);
+                __file.mtime = (long long) read_number(__in);
+                __entry.files.push_back(__file);
+            }
+
+            __n = read_number(__in);
+            for (std::size_t j = 0; __in && j < __n; ++j) {
+                pp_cache_entry::include_dependency __include;
+                __include.name = read_string(__in);
+                __include.policy = (int) read_number(__in);
+                __include.skip_current_path = read_number(__in) != 0;
+                __include.directory = read_string(__in);
+                __include.path = read_string(__in);
+                std::size_t __missing = read_number(__in);
+                for (std::size_t k = 0; __in && k < __missing; ++k)
+                    __include.missing.push_back(read_string(__in));
+                __entry.includes.push_back(__include);
+            }
+
+            __n = read_number(__in);
+            for (std::size_t j = 0; __in && j < __n; ++j) {
+                pp_cache_entry::macro_event __event;
+                __event.bind = read_number(__in) != 0;
+                __event.name = read_string(__in);
+                __event.definition = read_string(__in);
+                std::size_t __formals = read_number(__in);
+                for (std::size_t k = 0; __in && k < __formals; ++k)
+                    __event.formals.push_back(read_string(__in));
+                __event.function_like = read_number(__in) != 0;
+                __event.variadics = read_number(__in) != 0;
+                __event.lines = (int) read_number(__in);
+                __entry.events.push_back(__event);
+            }
+
+            __n = read_number(__in);
+            for (std::size_t j = 0; __in && j < __n; ++j) {
+                pp_cache_entry::child_output __child;
+                __child.offset = (std::size_t) read_number(__in);
+                __child.key = read_number(__in);
+                __child.id = read_number(__in);
+                __entry.children.push_back(__child);
+            }
+
+            __entry.output = read_string(__in);
+            __entry.id = read_number(__in);
+
+            if (__in)
+                __variants->push_back(__entry);
+        }
+    }
+
+    void save(std::string const &__file_name, std::vector<pp_cache_entry> const &__variants) const {
+        // write to a temporary file first, so that a concurrent or
+        // interrupted run never sees a truncated entry
+        std::string __tmp_name = __file_name + ".tmp";
+        std::ofstream __out(__tmp_name.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+        if (! __out)
+            return;
+
+        write_number(__out, __variants.size());
+        for (std::size_t i = 0; i < __variants.size(); ++i) {
+            pp_cache_entry const &__entry = __variants[i];
+
+            write_number(__out, __entry.macros.size());
+            for (std::size_t j = 0; j < __entry.macros.size(); ++j) {
+                write_string(__out, __entry.macros[j].name);
+                write_string(__out, __entry.macros[j].fingerprint);
+            }
+
+            write_number(__out, __entry.files.size());
+            for (std::size_t j = 0; j < __entry.files.size(); ++j) {
+                write_string(__out, __entry.files[j].path);
+                write_number(__out, __entry.files[j].hash);
+                write_number(__out, (pp_cache_hash) __entry.files[j].size);
+                write_number(__out, (pp_cache_hash) __entry.files[j].mtime);
+            }
+
+            write_number(__out, __entry.includes.size());
+            for (std::size_t j = 0; j < __entry.includes.size(); ++j) {
+                pp_cache_entry::include_dependency const &__include = __entry.includes[j];
+                write_string(__out, __include.name);
+                write_number(__out, (pp_cache_hash) __include.policy);
+                write_number(__out, __include.skip_current_path);
+                write_string(__out, __include.directory);
+                write_string(__out, __include.path);
+                write_number(__out, __include.missing.size());
+                for (std::size_t k = 0; k < __include.missing.size(); ++k)
+                    write_string(__out, __include.missing[k]);
+            }
+
+            write_number(__out, __entry.events.size());
+            for (std::size_t j = 0; j < __entry.events.size(); ++j) {
+                pp_cache_entry::macro_event const &__event = __entry.events[j];
+                write_number(__out, __event.bind);
+                write_string(__out, __event.name);
+                write_string(__out, __event.definition);
+                write_number(__out, __event.formals.size());
+                for (std::size_t k = 0; k < __event.formals.size(); ++k)
+                    write_string(__out, __event.formals[k]);
+                write_number(__out, __event.function_like);
+                write_number(__out, __event.variadics);
+                write_number(__out, (pp_cache_hash) __event.lines);
+            }
+
+            write_number(__out, __entry.children.size());
+            for (std::size_t j = 0; j < __entry.children.size(); ++j) {
+                write_number(__out, __entry.children[j].offset);
+                write_number(__out, __entry.children[j].key);
+                write_number(__out, __entry.children[j].id);
+            }
+
+            write_string(__out, __entry.output);
+            write_number(__out, __entry.id);
+        }
+
+        __out.close();
+        if (__out)
+            std::rename(__tmp_name.c_str(), __file_name.c_str());
+        else
+            std::remove(__tmp_name.c_str());
+    }
+
+    static pp_cache_hash hash_number(pp_cache_hash __n, pp_cache_hash __h) {
+        char __buffer[8];
+        for (int i = 0; i < 8; ++i)
+            __buffer[i] = (char)((__n >> (8 * i)) & 0xff);
+        return hash(__buffer, 8, __h);
+    }
+
+    static pp_cache_hash hash_string(std::string const &__s, pp_cache_hash __h) {
+        return hash(__s.c_str(), __s.size(), hash_number(__s.size(), __h));
+    }
+
+    static void write_number(std::ostream &__out, pp_cache_hash __n) {
+        char __buffer[8];
+        for (int i = 0; i < 8; ++i)
+            __buffer[i] = (char)((__n >> (8 * i)) & 0xff);
+        __out.write(__buffer, 8);
+    }
+
+    static pp_cache_hash read_number(std::istream &__in) {
+        unsigned char __buffer[8];
+        if (! __in.read(reinterpret_cast<char *>(__buffer), 8))
+            return 0;
+
+        pp_cache_hash __n = 0;
+        for (int i = 0; i < 8; ++i)
+            __n |= ((pp_cache_hash) __buffer[i]) << (8 * i);
+        return __n;
+    }
+
+    static void write_string(std::ostream &__out, std::string const &__s) {
+        write_number(__out, __s.size());
+        __out.write(__s.c_str(), __s.size());
+    }
+
+    static std::string read_string(std::istream &__in) {
+        std::size_t __size = (std::size_t) read_number(__in);
+        if (__size > MAX_STRING_SIZE) {
+            __in.setstate(std::ios::failbit);
+            return std::string();
+        }
+
+        std::string __s(__size, '\0');
+        if (__size && ! __in.read(&__s[0], __size))
+            return std::string();
+        return __s;
+    }
+
+private:
+    std::string _M_directory;
+    pp_cache_hash _M_context;
+    int _M_hits;
+    int _M_misses;
+
+private:
+    pp_cache(pp_cache const &);
+    void operator = (pp_cache const &);
+};
+
+} // namespace rpp
+
+#endif // PP_CACHE_H
+
+// kate: space-indent on; indent-width 2; replace-tabs on;
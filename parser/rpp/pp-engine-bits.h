@@ -66,7 +66,7 @@ void pp::file(std::string const &filename, _OutputIterator __result)
     if (fp != 0) {
         std::string was = env.current_file;
         env.current_file = filename;
-        file(fp, __result);
+        process_file(fp, __result);
         env.current_file = was;
     }
     //else
@@ -102,6 +102,72 @@ void pp::file(FILE *fp, _OutputIterator __result)
 #endif
 }
 
+template <typename _OutputIterator>
+void pp::process_file(FILE *fp, _OutputIterator __result)
+{
+    pp_profile *__profile = env.profile();
+    if (__profile) {
+        std::fseek(fp, 0, SEEK_END);
+        long __size = std::ftell(fp);
+        std::rewind(fp);
+        __profile->enter_file(env.current_file, __size > 0 ? __size : 0, pp_output_size(__result));
+    }
+
+    if (_M_cache)
+        process_cached_file(fp, __result);
+    else
+        file(fp, __result);
+
+    if (__profile)
+        __profile->leave_file(pp_output_size(__result));
+}
+
+template <typename _OutputIterator>
+void pp::process_cached_file(FILE *fp, _OutputIterator __result)
+{
+    assert(fp != 0);
+    assert(_M_cache != 0);
+
+    std::string __contents;
+    pp_cache::read_file(fp, &__contents);
+
+    if (_M_recorder)
+        _M_recorder->add_file_dependency(_M_cache->file_dependency(env.current_file, __contents));
+
+    pp_cache_hash __key = _M_cache->key(env.current_file, __contents);
+    pp_cache_entry __entry;
+    std::string __output;
+    if (_M_cache->lookup(__key, env, &__entry, &__output)) {
+        if (_M_recorder) {
+            _M_recorder->absorb(__entry);
+            _M_recorder->add_child_output(__key, __entry.id, __output.size());
+        }
+
+        pp_cache::replay(__entry, env);
+        std::copy(__output.begin(), __output.end(), __result);
+        return;
+    }
+
+    __output.clear();
+    __output.reserve(__contents.size());
+
+    pp_cache_recorder __recorder(env, _M_recorder, __output);
+    _M_recorder = &__recorder;
+    this->operator()(__contents.c_str(), __contents.c_str() + __contents.size(),
+                     pp_output_iterator<std::string>(__output));
+    _M_recorder = __recorder.parent();
+
+    __recorder.finish();
+    pp_cache_hash __id = _M_cache->store(__key, __recorder.entry());
+
+    if (_M_recorder) {
+        _M_recorder->absorb(__recorder.entry());
+        _M_recorder->add_child_output(__key, __id, __output.size());
+    }
+
+    std::copy(__output.begin(), __output.end(), __result);
+}
+
 template <typename _InputIterator>
 bool pp::find_header_protection(_InputIterator __first, _InputIterator __last, std::string *__prot)
 {
@@ -235,8 +301,108 @@ inline bool pp::file_exists(std::string const &__filename) const
 #endif
 }
 
-inline FILE *pp::find_include_file(std::string const &__input_filename, std::string *__filepath,
-                                   INCLUDE_POLICY __include_policy, bool __skip_current_path) const
+/* Tells whether __filename names something that is not a directory, like
+ * file_exists() && !file_isdir() but answered from a listing of the parent
+ * directory that is read only once per run.
+ */
+inline bool pp::include_file_exists(std::string const &__filename) const
+{
+#if defined(PP_OS_WIN)
+    return file_exists(__filename) && !file_isdir(__filename);
+#else
+    enum { ENTRY_FILE, ENTRY_DIR, ENTRY_UNKNOWN };
+
+    std::string::size_type __index = __filename.rfind(PATH_SEPARATOR);
+    std::string __dir = __index == std::string::npos ? std::string(".") : __filename.substr(0, __index + 1);
+    std::string __name = __index == std::string::npos ? __filename : __filename.substr(__index + 1);
+
+    std::map<std::string, std::map<std::string, int> >::iterator it = _M_directory_listings.find(__dir);
+    if (it == _M_directory_listings.end()) {
+        it = _M_directory_listings.insert(std::make_pair(__dir, std::map<std::string, int>())).first;
+
+        if (DIR *__d = opendir(__dir.c_str())) {
+            while (struct dirent *__entry = readdir(__d)) {
+                int __kind = ENTRY_UNKNOWN;
+#if defined(_DIRENT_HAVE_D_TYPE) || defined(DT_DIR)
+                if (__entry->d_type == DT_DIR)
+                    __kind = ENTRY_DIR;
+                else if (__entry->d_type != DT_UNKNOWN)
+                    __kind = ENTRY_FILE; // lstat() semantics: a symlink is not a directory
+#endif
+                it->second[__entry->d_name] = __kind;
+            }
+            closedir(__d);
+        }
+    }
+
+    std::map<std::string, int>::iterator __entry = it->second.find(__name);
+    if (__entry == it->second.end())
+        return false;
+
+    if (__entry->second == ENTRY_UNKNOWN)
+        __entry->second = file_isdir(__filename) ? ENTRY_DIR : ENTRY_FILE;
+
+    return __entry->second == ENTRY_FILE;
+#endif
+}
+
+/* Resolutions are kept for the whole run. __dependency, if given, is
+ * told how the name was resolved, for the preprocessor cache.
+ */
+inline bool pp::find_include_file(std::string const &__input_filename, std::string *__filepath,
+                                  INCLUDE_POLICY __include_policy, bool __skip_current_path,
+                                  pp_cache_entry::include_dependency *__dependency) const
+{
+    assert(__filepath != 0);
+
+    std::string __dir;
+    if (! env.current_file.empty())
+        _PP_internal::extract_file_path(env.current_file, &__dir);
+
+    if (__dependency) {
+        __dependency->name = __input_filename;
+        __dependency->policy = __include_policy;
+        __dependency->skip_current_path = __skip_current_path;
+        __dependency->directory = __dir;
+        __dependency->missing.clear();
+    }
+
+    if (is_absolute(__input_filename)) {
+        __filepath->assign(__input_filename);
+        if (__dependency)
+            __dependency->path = __input_filename;
+        return true;
+    }
+
+    std::string __key(__input_filename);
+    __key += '\0';
+    __key += char('0' + __include_policy);
+    __key += __skip_current_path ? '1' : '0';
+    __key += __dir;
+
+    std::map<std::string, include_resolution>::iterator it = _M_include_resolutions.find(__key);
+    if (it != _M_include_resolutions.end()) {
+        ++_M_include_cache_hits;
+    } else {
+        ++_M_include_cache_misses;
+        it = _M_include_resolutions.insert(std::make_pair(__key, include_resolution())).first;
+        if (! resolve_include_file(__input_filename, &it->second.path, __include_policy,
+                                   __skip_current_path, &it->second.missing))
+            it->second.path.clear();
+    }
+
+    if (__dependency) {
+        __dependency->path = it->second.path;
+        __dependency->missing = it->second.missing;
+    }
+
+    __filepath->assign(it->second.path);
+    return ! it->second.path.empty();
+}
+
+inline bool pp::resolve_include_file(std::string const &__input_filename, std::string *__filepath,
+                                     INCLUDE_POLICY __include_policy, bool __skip_current_path,
+                                     std::vector<std::string> *__missing) const
 {
     assert(__filepath != 0);
     assert(! __input_filename.empty());
@@ -244,7 +410,7 @@ inline FILE *pp::find_include_file(std::string const &__input_filename, std::str
     __filepath->assign(__input_filename);
 
     if (is_absolute(*__filepath))
-        return std::fopen(__filepath->c_str(), "r");
+        return true;
 
     if (! env.current_file.empty())
         _PP_internal::extract_file_path(env.current_file, __filepath);
@@ -253,10 +419,11 @@ inline FILE *pp::find_include_file(std::string const &__input_filename, std::str
         std::string __tmp(*__filepath);
         __tmp += __input_filename;
 
-        if (file_exists(__tmp) && !file_isdir(__tmp)) {
+        if (include_file_exists(__tmp)) {
             __filepath->append(__input_filename);
-            return std::fopen(__filepath->c_str(), "r");
+            return true;
         }
+        __missing->push_back(__tmp);
     }
 
     std::vector<std::string>::const_iterator it = include_paths.begin();
@@ -278,8 +445,9 @@ inline FILE *pp::find_include_file(std::string const &__input_filename, std::str
         __filepath->assign(*it);
         __filepath->append(__input_filename);
 
-        if (file_exists(*__filepath) && !file_isdir(*__filepath))
-            return std::fopen(__filepath->c_str(), "r");
+        if (include_file_exists(*__filepath))
+            return true;
+        __missing->push_back(*__filepath);
 
 #ifdef Q_OS_MAC
         // try in Framework path on Mac, if there is a path in front
@@ -292,15 +460,71 @@ inline FILE *pp::find_include_file(std::string const &__input_filename, std::str
             __filepath->append(__input_filename.substr(slashPos + 1, std::string::npos));
             std::cerr << *__filepath << "\n";
 
-            if (file_exists(*__filepath) && !file_isdir(*__filepath))
-                return fopen(__filepath->c_str(), "r");
+            if (include_file_exists(*__filepath))
+                return true;
+            __missing->push_back(*__filepath);
         }
 #endif // Q_OS_MAC
     }
 
-    return 0;
+    return false;
+}
+
+inline std::string pp::pragma_once_name(std::string const &__filepath) const
+{
+    // not a valid identifier, so it cannot clash with a real macro
+    return "#pragma once " + canonical_path(__filepath);
+}
+
+/* The path a file is known by in the include guard and "#pragma once"
+ * tables, so that a header reached as "a/../x.h" and as "x.h", or through
+ * a symbolic link, is skipped all the same. A path that can't be resolved
+ * is kept as it is.
+ */
+inline std::string const &pp::canonical_path(std::string const &__filepath) const
+{
+    std::map<std::string, std::string>::const_iterator it = _M_canonical_paths.find(__filepath);
+    if (it != _M_canonical_paths.end())
+        return it->second;
+
+    std::string __canonical = __filepath;
+#if defined (PP_OS_WIN)
+    // resolves "." and "..", symbolic links are rare there
+    char __buffer[MAX_PATH];
+    DWORD __size = GetFullPathNameA(__filepath.c_str(), MAX_PATH, __buffer, 0);
+    if (__size > 0 && __size < MAX_PATH)
+        __canonical.assign(__buffer, __size);
+#else
+    if (char *__resolved = ::realpath(__filepath.c_str(), 0)) {
+        __canonical = __resolved;
+        std::free(__resolved);
+    }
+#endif
+
+    return _M_canonical_paths.insert(std::make_pair(__filepath, __canonical)).first->second;
+}
+
+/* A file that was already included doesn't need to be opened again if it
+ * is protected by "#pragma once" or by an include guard that is defined.
+ * "#pragma once" is recorded as a macro, so it is part of the macro state
+ * seen by the preprocessor cache; the include guard table is not, so it is
+ * bypassed while a cache entry is being recorded.
+ */
+inline bool pp::is_include_skipped(std::string const &__filepath) const
+{
+    std::string __once = pragma_once_name(__filepath);
+    if (env.resolve(__once.c_str(), __once.size()) != 0)
+        return true;
+
+    if (_M_recorder)
+        return false;
+
+    std::map<std::string, std::string>::const_iterator it = _M_include_guards.find(canonical_path(__filepath));
+    return it != _M_include_guards.end()
+           && env.resolve(it->second.c_str(), it->second.size()) != 0;
 }
 
+
 template <typename _InputIterator, typename _OutputIterator>
 _InputIterator pp::handle_directive(char const *__directive, std::size_t __size,
                                     _InputIterator __first, _InputIterator __last, _OutputIterator __result)
@@ -333,6 +557,11 @@ _InputIterator pp::handle_directive(char const *__directive, std::size_t __size,
             return handle_undef(__first, __last);
         break;
 
+    case PP_PRAGMA:
+        if (! skipping())
+            return handle_pragma(__first, __last);
+        break;
+
     case PP_ELIF:
         return handle_elif(__first, __last);
 
@@ -400,7 +629,25 @@ _InputIterator pp::handle_include(bool __skip_current_path, _InputIterator __fir
 #endif
 
     std::string filepath;
-    FILE *fp = find_include_file(filename, &filepath, quote == '>' ? INCLUDE_GLOBAL : INCLUDE_LOCAL, __skip_current_path);
+    FILE *fp = 0;
+    pp_cache_entry::include_dependency __dependency;
+    bool __found = find_include_file(filename, &filepath, quote == '>' ? INCLUDE_GLOBAL : INCLUDE_LOCAL,
+                                     __skip_current_path, _M_recorder ? &__dependency : 0);
+    if (_M_recorder)
+        _M_recorder->add_include_dependency(__dependency);
+
+    if (__found) {
+        if (is_include_skipped(filepath)) {
+            if (pp_profile *__profile = env.profile())
+                __profile->include_skipped(filepath);
+#if defined (PP_HOOK_ON_FILE_INCLUDED)
+            PP_HOOK_ON_FILE_INCLUDED(env.current_file, filepath, 0);
+#endif
+            return __first;
+        }
+
+        fp = std::fopen(filepath.c_str(), "r");
+    }
 
 #if defined (PP_HOOK_ON_FILE_INCLUDED)
     PP_HOOK_ON_FILE_INCLUDED(env.current_file, fp ? filepath : filename, fp);
@@ -414,7 +661,7 @@ _InputIterator pp::handle_include(bool __skip_current_path, _InputIterator __fir
         env.current_line = 1;
         //output_line (env.current_file, 1, __result);
 
-        file(fp, __result);
+        process_file(fp, __result);
 
         // restore the file name and the line position
         env.current_file = old_file;
@@ -434,16 +681,14 @@ _InputIterator pp::handle_include(bool __skip_current_path, _InputIterator __fir
 template <typename _InputIterator, typename _OutputIterator>
 void pp::operator()(_InputIterator __first, _InputIterator __last, _OutputIterator __result)
 {
-#ifndef PP_NO_SMART_HEADER_PROTECTION
+    // the leading #ifndef is only an include guard if its #endif closes
+    // the file, check that while going through it
     std::string __prot;
-    __prot.reserve(255);
-    pp_fast_string __tmp(__prot.c_str(), __prot.size());
-
-    if (find_header_protection(__first, __last, &__prot)
-        && env.resolve(&__tmp) != 0) {
-        // std::cerr << "** DEBUG found header protection:" << __prot << std::endl;
-        return;
-    }
+    bool __guarded = false;
+    bool __guard_closed = false;
+    int const __guard_level = iflevel;
+#ifndef PP_NO_SMART_HEADER_PROTECTION
+    __guarded = ! env.current_file.empty() && find_header_protection(__first, __last, &__prot);
 #endif
 
     env.current_line = 1;
@@ -455,7 +700,11 @@ void pp::operator()(_InputIterator __first, _InputIterator __last, _OutputIterat
 
         if (__first == __last)
             break;
-        else if (*__first == '#') {
+
+        if (__guard_closed && *__first != '\n')
+            __guarded = false;
+
+        if (*__first == '#') {
             assert(*__first == '#');
             __first = skip_blanks(++__first, __last);
             env.current_line += skip_blanks.lines;
@@ -475,6 +724,9 @@ void pp::operator()(_InputIterator __first, _InputIterator __last, _OutputIterat
             int was = env.current_line;
             (void) handle_directive(__buffer, __size, end_id, __first, __result);
 
+            if (__guarded && iflevel == __guard_level)
+                __guard_closed = true;
+
             if (env.current_line != was) {
                 env.current_line = was;
                 _PP_internal::output_line(env.current_file, env.current_line, __result);
@@ -494,10 +746,14 @@ void pp::operator()(_InputIterator __first, _InputIterator __last, _OutputIterat
                 _PP_internal::output_line(env.current_file, env.current_line, __result);
         }
     }
+
+    if (__guarded && __guard_closed)
+        _M_include_guards[canonical_path(env.current_file)] = __prot;
 }
 
 inline pp::pp(pp_environment &__env):
-        env(__env), expand(env)
+        env(__env), expand(env), _M_cache(0), _M_recorder(0),
+        _M_include_cache_hits(0), _M_include_cache_misses(0)
 {
     iflevel = 0;
     _M_skipping[iflevel] = 0;
@@ -529,8 +785,41 @@ inline std::vector<std::string>::const_iterator pp::include_paths_end() const
     return include_paths.end();
 }
 
+inline pp_cache *pp::cache() const
+{
+    return _M_cache;
+}
+
+inline void pp::set_cache(pp_cache *__cache)
+{
+    _M_cache = __cache;
+}
+
+// the profile is kept by the environment, so macro expansions get to it
+inline pp_profile *pp::profile() const
+{
+    return env.profile();
+}
+
+inline void pp::set_profile(pp_profile *__profile)
+{
+    env.set_profile(__profile);
+}
+
+inline int pp::include_cache_hits() const
+{
+    return _M_include_cache_hits;
+}
+
+inline int pp::include_cache_misses() const
+{
+    return _M_include_cache_misses;
+}
+
 inline void pp::push_include_path(std::string const &__path)
 {
+    _M_include_resolutions.clear();
+
     if (__path.empty() || __path [__path.size() - 1] != PATH_SEPARATOR) {
         std::string __tmp(__path);
         __tmp += PATH_SEPARATOR;
@@ -546,13 +835,13 @@ _InputIterator pp::handle_define(_InputIterator __first, _InputIterator __last)
 {
     pp_macro macro;
 #if defined (PP_WITH_MACRO_POSITION)
-    macro.file = pp_symbol::get(env.current_file);
+    macro.file = env.symbols().get(env.current_file);
 #endif
     std::string definition;
 
     __first = skip_blanks(__first, __last);
     _InputIterator end_macro_name = skip_identifier(__first, __last);
-    pp_fast_string const *macro_name = pp_symbol::get(__first, end_macro_name);
+    pp_fast_string const *macro_name = env.symbols().get(__first, end_macro_name);
     __first = end_macro_name;
 
     if (__first != __last && *__first == '(') {
@@ -562,7 +851,7 @@ _InputIterator pp::handle_define(_InputIterator __first, _InputIterator __last)
         __first = skip_blanks(++__first, __last);  // skip '('
         _InputIterator arg_end = skip_identifier(__first, __last);
         if (__first != arg_end)
-            macro.formals.push_back(pp_symbol::get(__first, arg_end));
+            macro.formals.push_back(env.symbols().get(__first, arg_end));
 
         __first = skip_blanks(arg_end, __last);
 
@@ -577,7 +866,7 @@ _InputIterator pp::handle_define(_InputIterator __first, _InputIterator __last)
 
             arg_end = skip_identifier(__first, __last);
             if (__first != arg_end)
-                macro.formals.push_back(pp_symbol::get(__first, arg_end));
+                macro.formals.push_back(env.symbols().get(__first, arg_end));
 
             __first = skip_blanks(arg_end, __last);
 
@@ -600,8 +889,9 @@ _InputIterator pp::handle_define(_InputIterator __first, _InputIterator __last)
      */
     bool in_path = false;
     while (__first != __last && *__first != '\n') {
+        _InputIterator __next = __first + 1;
         if ((*__first == '<' || *__first == '"') &&
-            (*(__first + 1) != '*' && *(__first + 1) != '/')) {
+            (__next == __last || (*__next != '*' && *__next != '/'))) {
             in_path = true;
             goto skip_path;
         }
@@ -617,12 +907,14 @@ _InputIterator pp::handle_define(_InputIterator __first, _InputIterator __last)
         }
 
         if (*__first == '/') {
-            if (*(__first + 1) != '*' && *(__first + 1) != '/') {
+            if (__next == __last || (*__next != '*' && *__next != '/')) {
                 in_path = true;
                 goto skip_path;
             } else {
                 __first = skip_comment_or_divop(__first, __last);
                 env.current_line += skip_comment_or_divop.lines;
+                if (__first == __last)
+                    break;
             }
         }
 
@@ -642,7 +934,7 @@ skip_path:
         definition += *__first++;
     }
 
-    macro.definition = pp_symbol::get(definition);
+    macro.definition = env.symbols().get(definition);
     env.bind(macro_name, macro);
 
     return __first;
@@ -673,7 +965,7 @@ _InputIterator pp::skip(_InputIterator __first, _InputIterator __last)
                 ++env.current_line;
             }
         } else
-            ++__first;
+            __first = pp_find_any(++__first, __last, "\n/\"'\\");
     }
 
     return __first;
@@ -1164,6 +1456,21 @@ _InputIterator pp::handle_undef(_InputIterator __first, _InputIterator __last)
     return __first;
 }
 
+template <typename _InputIterator>
+_InputIterator pp::handle_pragma(_InputIterator __first, _InputIterator __last)
+{
+    __first = skip_blanks(__first, __last);
+    _InputIterator end_pragma = skip_identifier(__first, __last);
+
+    if (std::string(__first, end_pragma) == "once" && ! env.current_file.empty()) {
+        pp_macro __macro;
+        __macro.definition = env.symbols().get(std::string());
+        env.bind(env.symbols().get(pragma_once_name(env.current_file)), __macro);
+    }
+
+    return end_pragma;
+}
+
 template <typename _InputIterator>
 char pp::peek_char(_InputIterator __first, _InputIterator __last)
 {
@@ -30,6 +30,7 @@
 #include "pp-scanner.h"
 #include "pp-macro-expander.h"
 #include "pp-environment.h"
+#include "pp-cache.h"
 
 namespace rpp
 {
@@ -109,6 +110,20 @@ class pp
     pp_skip_number skip_number;
     std::vector<std::string> include_paths;
     std::string _M_current_text;
+    pp_cache *_M_cache;
+    pp_cache_recorder *_M_recorder;
+    std::map<std::string, std::string> _M_include_guards;  // by canonical_path()
+    mutable std::map<std::string, std::string> _M_canonical_paths;
+
+    // include resolution cache, an empty path marks a failed lookup
+    struct include_resolution {
+        std::string path;
+        std::vector<std::string> missing;  // the candidates tried before it
+    };
+    mutable std::map<std::string, include_resolution> _M_include_resolutions;
+    mutable std::map<std::string, std::map<std::string, int> > _M_directory_listings;
+    mutable int _M_include_cache_hits;
+    mutable int _M_include_cache_misses;
 
     enum { MAX_LEVEL = 512 };
     int _M_skipping[MAX_LEVEL];
@@ -172,6 +187,15 @@ public:
     inline std::vector<std::string>::const_iterator include_paths_begin() const;
     inline std::vector<std::string>::const_iterator include_paths_end() const;
 
+    inline pp_cache *cache() const;
+    inline void set_cache(pp_cache *__cache);
+
+    inline pp_profile *profile() const;
+    inline void set_profile(pp_profile *__profile);
+
+    inline int include_cache_hits() const;
+    inline int include_cache_misses() const;
+
     template <typename _InputIterator>
     inline _InputIterator eval_expression(_InputIterator __first, _InputIterator __last, Value *result);
 
@@ -185,10 +209,24 @@ public:
     void operator()(_InputIterator __first, _InputIterator __last, _OutputIterator __result);
 
 private:
+    template <typename _OutputIterator>
+    void process_file(FILE *fp, _OutputIterator __result);
+
+    template <typename _OutputIterator>
+    void process_cached_file(FILE *fp, _OutputIterator __result);
+
     inline bool file_isdir(std::string const &__filename) const;
     inline bool file_exists(std::string const &__filename) const;
-    FILE *find_include_file(std::string const &__filename, std::string *__filepath,
-                            INCLUDE_POLICY __include_policy, bool __skip_current_path = false) const;
+    bool include_file_exists(std::string const &__filename) const;
+    bool find_include_file(std::string const &__filename, std::string *__filepath,
+                           INCLUDE_POLICY __include_policy, bool __skip_current_path = false,
+                           pp_cache_entry::include_dependency *__dependency = 0) const;
+    bool resolve_include_file(std::string const &__filename, std::string *__filepath,
+                              INCLUDE_POLICY __include_policy, bool __skip_current_path,
+                              std::vector<std::string> *__missing) const;
+    bool is_include_skipped(std::string const &__filepath) const;
+    inline std::string pragma_once_name(std::string const &__filepath) const;
+    std::string const &canonical_path(std::string const &__filepath) const;
 
     inline int skipping() const;
     bool test_if_level();
@@ -269,6 +307,9 @@ private:
     template <typename _InputIterator>
     _InputIterator handle_undef(_InputIterator __first, _InputIterator __last);
 
+    template <typename _InputIterator>
+    _InputIterator handle_pragma(_InputIterator __first, _InputIterator __last);
+
     template <typename _InputIterator>
     inline char peek_char(_InputIterator __first, _InputIterator __last);
 
@@ -29,10 +29,30 @@
 #include <string>
 #include <cstring>
 #include "pp-macro.h"
+#include "pp-profile.h"
 
 namespace rpp
 {
 
+/* Gets notified about every macro lookup, definition and removal made
+ * through a pp_environment. Used by the preprocessor cache to find out
+ * which part of the macro state the output of a file depends on.
+ */
+class pp_macro_observer
+{
+public:
+    virtual ~pp_macro_observer() {}
+
+    virtual void macro_resolved(pp_fast_string const &__name, pp_macro const *__macro) = 0;
+    virtual void macro_bound(pp_macro const &__macro) = 0;
+    virtual void macro_unbound(pp_fast_string const &__name) = 0;
+};
+
+/* Macros are kept in an open addressing table with linear probing. Each
+ * slot caches the hash of the name, so probing a slot that belongs to
+ * another macro doesn't touch its name, and growing the table doesn't
+ * rehash any string. #undef removes the macro from the table.
+ */
 class pp_environment
 {
 public:
@@ -41,15 +61,58 @@ public:
 public:
     pp_environment():
             current_line(0),
-            _M_hash_size(4093) {
-        _M_base = (pp_macro **) memset(new pp_macro* [_M_hash_size], 0, _M_hash_size * sizeof(pp_macro*));
+            _M_symbols(new pp_symbol_table),
+            _M_shared_symbols(false),
+            _M_observer(0),
+            _M_profile(0),
+            _M_slots(0),
+            _M_mask(INITIAL_SIZE - 1),
+            _M_count(0) {
+        _M_slots = new slot[INITIAL_SIZE];
+        memset(_M_slots, 0, INITIAL_SIZE * sizeof(slot));
+    }
+
+    // a snapshot of the macros defined in __other, the observer and the profile
+    // aren't copied.
+    // The snapshot interns its symbols in the table of __other, which must
+    // outlive it.
+    pp_environment(pp_environment const &__other):
+            current_file(__other.current_file),
+            current_line(__other.current_line),
+            _M_symbols(__other._M_symbols),
+            _M_shared_symbols(true),
+            _M_observer(0),
+            _M_profile(0),
+            _M_slots(0),
+            _M_mask(INITIAL_SIZE - 1),
+            _M_count(0) {
+        _M_slots = new slot[INITIAL_SIZE];
+        memset(_M_slots, 0, INITIAL_SIZE * sizeof(slot));
+
+        // redefined and removed macros are still in _M_macros, skip them
+        for (std::size_t i = 0; i < __other._M_macros.size(); ++i) {
+            pp_macro const *__macro = __other._M_macros[i];
+            std::size_t __index = __other.find_slot(*__macro->name, __macro->name->hash());
+            if (__other._M_slots[__index].macro == __macro)
+                bind(__macro->name, *__macro);
+        }
     }
 
     ~pp_environment() {
         for (std::size_t i = 0; i < _M_macros.size(); ++i)
             delete _M_macros [i];
 
-        delete [] _M_base;
+        delete [] _M_slots;
+
+        if (! _M_shared_symbols)
+            delete _M_symbols;
+
+        for (std::size_t i = 0; i < _M_free_actuals.size(); ++i)
+            delete _M_free_actuals[i];
+    }
+
+    inline pp_symbol_table &symbols() const {
+        return *_M_symbols;
     }
 
     const_iterator first_macro() const {
@@ -60,22 +123,33 @@ public:
     }
 
     inline void bind(pp_fast_string const *__name, pp_macro const &__macro) {
-        std::size_t h = hash_code(*__name) % _M_hash_size;
         pp_macro *m = new pp_macro(__macro);
         m->name = __name;
-        m->next = _M_base [h];
-        m->hash_code = h;
-        _M_base [h] = m;
-
         _M_macros.push_back(m);
 
-        if (_M_macros.size() == _M_hash_size)
-            rehash();
+        std::size_t __hash = __name->hash();
+        std::size_t __index = find_slot(*__name, __hash);
+        if (_M_slots[__index].macro) {
+            // redefinition
+            _M_slots[__index].macro = m;
+        } else {
+            _M_slots[__index].hash = __hash;
+            _M_slots[__index].macro = m;
+            if (++_M_count * 2 > _M_mask + 1)
+                grow();
+        }
+
+        if (_M_observer)
+            _M_observer->macro_bound(*m);
     }
 
     inline void unbind(pp_fast_string const *__name) {
-        if (pp_macro *m = resolve(__name))
-            m->hidden = true;
+        std::size_t __index = find_slot(*__name, __name->hash());
+        if (_M_slots[__index].macro)
+            remove_slot(__index);
+
+        if (_M_observer)
+            _M_observer->macro_unbound(*__name);
     }
 
     inline void unbind(char const *__s, std::size_t __size) {
@@ -83,12 +157,14 @@ public:
         unbind(&__tmp);
     }
 
+    // a macro that is hidden because it is being expanded doesn't resolve
     inline pp_macro *resolve(pp_fast_string const *__name) const {
-        std::size_t h = hash_code(*__name) % _M_hash_size;
-        pp_macro *it = _M_base [h];
+        pp_macro *it = _M_slots[find_slot(*__name, __name->hash())].macro;
+        if (it && it->hidden)
+            it = 0;
 
-        while (it && it->name && it->hash_code == h && (*it->name != *__name || it->hidden))
-            it = it->next;
+        if (_M_observer)
+            _M_observer->macro_resolved(*__name, it);
 
         return it;
     }
@@ -98,38 +174,127 @@ public:
         return resolve(&__tmp);
     }
 
+    inline std::size_t macro_count() const {
+        return _M_count;
+    }
+
+    // the number of slots, macro_count() over it is the load factor
+    inline std::size_t table_size() const {
+        return _M_mask + 1;
+    }
+
+    // scratch space for macro expansion, taken and given back in stack order
+    inline pp_actuals *acquire_actuals() {
+        if (_M_free_actuals.empty())
+            return new pp_actuals;
+
+        pp_actuals *__actuals = _M_free_actuals.back();
+        _M_free_actuals.pop_back();
+        __actuals->clear();
+        return __actuals;
+    }
+
+    inline void release_actuals(pp_actuals *__actuals) {
+        _M_free_actuals.push_back(__actuals);
+    }
+
+    inline pp_macro_observer *observer() const {
+        return _M_observer;
+    }
+
+    inline void set_observer(pp_macro_observer *__observer) {
+        _M_observer = __observer;
+    }
+
+    inline pp_profile *profile() const {
+        return _M_profile;
+    }
+
+    inline void set_profile(pp_profile *__profile) {
+        _M_profile = __profile;
+    }
+
     std::string current_file;
     int current_line;
 
 private:
-    inline std::size_t hash_code(pp_fast_string const &s) const {
-        std::size_t hash_value = 0;
+    enum { INITIAL_SIZE = 4096 };
 
-        for (std::size_t i = 0; i < s.size(); ++i)
-            hash_value = (hash_value << 5) - hash_value + s.at(i);
+    struct slot {
+        std::size_t hash;
+        pp_macro *macro;
+    };
 
-        return hash_value;
+    inline std::size_t home_slot(std::size_t __hash) const {
+        return (__hash ^ (__hash >> 15)) & _M_mask;
     }
 
-    void rehash() {
-        delete[] _M_base;
+    // the slot holding __name, or the empty slot where it would be inserted
+    inline std::size_t find_slot(pp_fast_string const &__name, std::size_t __hash) const {
+        std::size_t __index = home_slot(__hash);
+        while (_M_slots[__index].macro
+               && (_M_slots[__index].hash != __hash || *_M_slots[__index].macro->name != __name))
+            __index = (__index + 1) & _M_mask;
+        return __index;
+    }
 
-        _M_hash_size <<= 1;
+    // backward shift deletion, keeps every probe sequence free of holes
+    void remove_slot(std::size_t __index) {
+        std::size_t __next = __index;
+        while (true) {
+            __next = (__next + 1) & _M_mask;
+            if (! _M_slots[__next].macro)
+                break;
 
-        _M_base = (pp_macro **) memset(new pp_macro* [_M_hash_size], 0, _M_hash_size * sizeof(pp_macro*));
-        for (std::size_t index = 0; index < _M_macros.size(); ++index) {
-            pp_macro *elt = _M_macros [index];
-            std::size_t h = hash_code(*elt->name) % _M_hash_size;
-            elt->next = _M_base [h];
-            elt->hash_code = h;
-            _M_base [h] = elt;
+            std::size_t __home = home_slot(_M_slots[__next].hash);
+            bool __movable = (__next > __index)
+                             ? (__home <= __index || __home > __next)
+                             : (__home <= __index && __home > __next);
+            if (__movable) {
+                _M_slots[__index] = _M_slots[__next];
+                __index = __next;
+            }
         }
+
+        _M_slots[__index].macro = 0;
+        _M_slots[__index].hash = 0;
+        --_M_count;
     }
 
+    void grow() {
+        slot *__old = _M_slots;
+        std::size_t __old_size = _M_mask + 1;
+
+        _M_mask = (__old_size << 1) - 1;
+        _M_slots = new slot[_M_mask + 1];
+        memset(_M_slots, 0, (_M_mask + 1) * sizeof(slot));
+
+        for (std::size_t i = 0; i < __old_size; ++i) {
+            if (! __old[i].macro)
+                continue;
+
+            std::size_t __index = home_slot(__old[i].hash);
+            while (_M_slots[__index].macro)
+                __index = (__index + 1) & _M_mask;
+            _M_slots[__index] = __old[i];
+        }
+
+        delete [] __old;
+    }
+
+private:
+    pp_environment &operator=(pp_environment const &);
+
 private:
+    pp_symbol_table *_M_symbols;
+    bool _M_shared_symbols;
+    pp_macro_observer *_M_observer;
+    pp_profile *_M_profile;
     std::vector<pp_macro*> _M_macros;
-    pp_macro **_M_base;
-    std::size_t _M_hash_size;
+    std::vector<pp_actuals*> _M_free_actuals;
+    slot *_M_slots;
+    std::size_t _M_mask;
+    std::size_t _M_count;
 };
 
 } // namespace rpp
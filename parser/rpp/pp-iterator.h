@@ -76,6 +76,10 @@ public:
         return *this;
     }
 
+    inline std::size_t size() const {
+        return _M_result.size();
+    }
+
     inline pp_output_iterator &operator *() {
         return *this;
     }
@@ -87,6 +91,19 @@ public:
     }
 };
 
+// the number of characters written so far, when the iterator knows it
+template <typename _OutputIterator>
+inline std::size_t pp_output_size(_OutputIterator const &)
+{
+    return 0;
+}
+
+template <typename _Container>
+inline std::size_t pp_output_size(pp_output_iterator<_Container> const &__result)
+{
+    return __result.size();
+}
+
 } // namespace rpp
 
 #endif // PP_ITERATOR_H
@@ -30,9 +30,9 @@ namespace rpp
 
 struct pp_frame {
     pp_macro *expanding_macro;
-    std::vector<std::string> *actuals;
+    pp_actuals const *actuals;
 
-    pp_frame(pp_macro *__expanding_macro, std::vector<std::string> *__actuals):
+    pp_frame(pp_macro *__expanding_macro, pp_actuals const *__actuals):
             expanding_macro(__expanding_macro), actuals(__actuals) {}
 };
 
@@ -40,6 +40,7 @@ class pp_macro_expander
 {
     pp_environment &env;
     pp_frame *frame;
+    bool hide_next;  // the identifier after "defined" isn't expanded
 
     pp_skip_number skip_number;
     pp_skip_identifier skip_identifier;
@@ -50,7 +51,7 @@ class pp_macro_expander
     pp_skip_blanks skip_blanks;
     pp_skip_whitespaces skip_whitespaces;
 
-    std::string const *resolve_formal(pp_fast_string const *__name) {
+    pp_fast_string const *resolve_formal(pp_fast_string const *__name) {
         assert(__name != 0);
 
         if (! frame)
@@ -58,7 +59,7 @@ class pp_macro_expander
 
         assert(frame->expanding_macro != 0);
 
-        std::vector<pp_fast_string const *> const formals = frame->expanding_macro->formals;
+        std::vector<pp_fast_string const *> const &formals = frame->expanding_macro->formals;
         for (std::size_t index = 0; index < formals.size(); ++index) {
             pp_fast_string const *formal = formals[index];
 
@@ -66,7 +67,7 @@ class pp_macro_expander
                 continue;
 
             else if (frame->actuals && index < frame->actuals->size())
-                return &(*frame->actuals)[index];
+                return &frame->actuals->at(index);
 
             else
                 assert(0);  // internal error?
@@ -81,7 +82,7 @@ public: // attributes
 
 public:
     pp_macro_expander(pp_environment &__env, pp_frame *__frame = 0):
-            env(__env), frame(__frame), lines(0), generated_lines(0) {}
+            env(__env), frame(__frame), hide_next(false), lines(0), generated_lines(0) {}
 
     template <typename _InputIterator, typename _OutputIterator>
     _InputIterator operator()(_InputIterator __first, _InputIterator __last, _OutputIterator __result) {
@@ -113,10 +114,10 @@ public:
 
                 pp_fast_string fast_name(name_buffer, name_size);
 
-                if (std::string const *actual = resolve_formal(&fast_name)) {
+                if (pp_fast_string const *actual = resolve_formal(&fast_name)) {
                     *__result++ = '\"';
 
-                    for (std::string::const_iterator it = skip_whitespaces(actual->begin(), actual->end());
+                    for (char const *it = skip_whitespaces(actual->begin(), actual->end());
                          it != actual->end(); ++it) {
                         if (*it == '"') {
                             *__result++ = '\\';
@@ -196,13 +197,11 @@ public:
 
                 pp_fast_string fast_name(name_buffer, name_size);
 
-                if (std::string const *actual = resolve_formal(&fast_name)) {
+                if (pp_fast_string const *actual = resolve_formal(&fast_name)) {
                     std::copy(actual->begin(), actual->end(), __result);
                     continue;
                 }
 
-                static bool hide_next = false; // ### remove me
-
                 pp_macro *macro = env.resolve(name_buffer, name_size);
                 if (! macro || macro->hidden || hide_next) {
                     hide_next = ! strcmp(name_buffer, "defined");
@@ -234,34 +233,35 @@ public:
                     if (macro->definition) {
                         macro->hidden = true;
 
-                        std::string __tmp;
-                        __tmp.reserve(256);
+                        pp_actuals *__scratch = env.acquire_actuals();
+                        std::string &__tmp = __scratch->text();
 
                         pp_macro_expander expand_macro(env);
                         expand_macro(macro->definition->begin(), macro->definition->end(), std::back_inserter(__tmp));
                         generated_lines += expand_macro.lines;
 
+                        if (pp_profile *__profile = env.profile())
+                            __profile->macro_expanded(*macro->name, __tmp.size());
+
                         if (! __tmp.empty()) {
                             std::string::iterator __begin_id = skip_whitespaces(__tmp.begin(), __tmp.end());
                             std::string::iterator __end_id = skip_identifier(__begin_id, __tmp.end());
 
                             if (__end_id == __tmp.end()) {
-                                std::string __id;
-                                __id.assign(__begin_id, __end_id);
-
                                 std::size_t x;
 #if defined(__SUNPRO_CC)
                                 std::distance(__begin_id, __end_id, x);
 #else
                                 x = std::distance(__begin_id, __end_id);
 #endif
-                                m = env.resolve(__id.c_str(), x);
+                                m = env.resolve(&*__begin_id, x);
                             }
 
                             if (! m)
                                 std::copy(__tmp.begin(), __tmp.end(), __result);
                         }
 
+                        env.release_actuals(__scratch);
                         macro->hidden = false;
                     }
 
@@ -281,29 +281,27 @@ public:
                     continue;
                 }
 
-                std::vector<std::string> actuals;
-                actuals.reserve(5);
+                // the actuals are expanded straight from the input
+                pp_actuals *actuals = env.acquire_actuals();
                 ++arg_it; // skip '('
 
                 pp_macro_expander expand_actual(env, frame);
 
-                _InputIterator arg_end = skip_argument_variadics(actuals, macro, arg_it, __last);
+                _InputIterator arg_end = skip_argument_variadics(*actuals, macro, arg_it, __last);
                 if (arg_it != arg_end) {
-                    std::string actual(arg_it, arg_end);
-                    actuals.resize(actuals.size() + 1);
-                    actuals.back().reserve(255);
-                    expand_actual(actual.begin(), actual.end(), std::back_inserter(actuals.back()));
+                    actuals->begin_actual();
+                    expand_actual(arg_it, arg_end, std::back_inserter(actuals->text()));
+                    actuals->end_actual();
                     arg_it = arg_end;
                 }
 
                 while (arg_it != __last && *arg_end == ',') {
                     ++arg_it; // skip ','
 
-                    arg_end = skip_argument_variadics(actuals, macro, arg_it, __last);
-                    std::string actual(arg_it, arg_end);
-                    actuals.resize(actuals.size() + 1);
-                    actuals.back().reserve(255);
-                    expand_actual(actual.begin(), actual.end(), std::back_inserter(actuals.back()));
+                    arg_end = skip_argument_variadics(*actuals, macro, arg_it, __last);
+                    actuals->begin_actual();
+                    expand_actual(arg_it, arg_end, std::back_inserter(actuals->text()));
+                    actuals->end_actual();
                     arg_it = arg_end;
                 }
 
@@ -313,16 +311,28 @@ public:
                 __first = arg_it;
 
 #if 0 // ### enable me
-                assert((macro->variadics && macro->formals.size() >= actuals.size())
-                       || macro->formals.size() == actuals.size());
+                assert((macro->variadics && macro->formals.size() >= actuals->size())
+                       || macro->formals.size() == actuals->size());
 #endif
 
-                pp_frame frame(macro, &actuals);
+                actuals->finish();
+                pp_frame frame(macro, actuals);
                 pp_macro_expander expand_macro(env, &frame);
                 macro->hidden = true;
-                expand_macro(macro->definition->begin(), macro->definition->end(), __result);
+                if (pp_profile *__profile = env.profile()) {
+                    // expanded aside to measure it
+                    pp_actuals *__scratch = env.acquire_actuals();
+                    std::string &__tmp = __scratch->text();
+                    expand_macro(macro->definition->begin(), macro->definition->end(), std::back_inserter(__tmp));
+                    __profile->macro_expanded(*macro->name, __tmp.size());
+                    std::copy(__tmp.begin(), __tmp.end(), __result);
+                    env.release_actuals(__scratch);
+                } else {
+                    expand_macro(macro->definition->begin(), macro->definition->end(), __result);
+                }
                 macro->hidden = false;
                 generated_lines += expand_macro.lines;
+                env.release_actuals(actuals);
             } else
                 *__result++ = *__first++;
         }
@@ -331,7 +341,7 @@ public:
     }
 
     template <typename _InputIterator>
-    _InputIterator skip_argument_variadics(std::vector<std::string> const &__actuals, pp_macro *__macro,
+    _InputIterator skip_argument_variadics(pp_actuals const &__actuals, pp_macro *__macro,
                                            _InputIterator __first, _InputIterator __last) {
         _InputIterator arg_end = skip_argument(__first, __last);
 
@@ -26,6 +26,7 @@
 #define PP_MACRO_H
 
 #include <vector>
+#include <string>
 #include "pp-fwd.h"
 
 namespace rpp
@@ -50,8 +51,6 @@ struct pp_macro {
     };
 
     int lines;
-    pp_macro *next;
-    std::size_t hash_code;
 
     inline pp_macro():
 #if defined (PP_WITH_MACRO_POSITION)
@@ -60,9 +59,52 @@ struct pp_macro {
             name(0),
             definition(0),
             state(0),
-            lines(0),
-            next(0),
-            hash_code(0) {}
+            lines(0) {}
+};
+
+/* The macro-expanded actual arguments of a macro invocation, stored one
+ * after the other in a single buffer. pp_environment recycles these, so
+ * once their buffers have grown collecting actuals doesn't allocate.
+ */
+class pp_actuals
+{
+public:
+    inline void clear() {
+        _M_text.clear();
+        _M_bounds.clear();
+        _M_views.clear();
+    }
+
+    inline std::size_t size() const {
+        return _M_bounds.size() / 2;
+    }
+
+    // the text of the actual being collected is appended to text()
+    inline void begin_actual() {
+        _M_bounds.push_back(_M_text.size());
+    }
+    inline void end_actual() {
+        _M_bounds.push_back(_M_text.size());
+    }
+
+    inline std::string &text() {
+        return _M_text;
+    }
+
+    // views into text(), valid once every actual has been collected
+    inline void finish() {
+        for (std::size_t i = 0; i < _M_bounds.size(); i += 2)
+            _M_views.push_back(pp_fast_string(_M_text.data() + _M_bounds[i], _M_bounds[i + 1] - _M_bounds[i]));
+    }
+
+    inline pp_fast_string const &at(std::size_t __index) const {
+        return _M_views[__index];
+    }
+
+private:
+    std::string _M_text;
+    std::vector<std::size_t> _M_bounds;
+    std::vector<pp_fast_string> _M_views;
 };
 
 } // namespace rpp
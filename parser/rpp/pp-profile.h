@@ -0,0 +1,202 @@
+/*
+ * This file is part of the API Extractor project.
+ *
+ * Copyright (C) 2009 Nokia Corporation and/or its subsidiary(-ies).
+ *
+ * Contact: PySide team <contact@pyside.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+
+#ifndef PP_PROFILE_H
+#define PP_PROFILE_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include <ostream>
+#include <cstdio>
+
+#if !defined (PP_OS_WIN)
+#  include <sys/time.h>
+#endif
+
+#include "pp-fwd.h"
+
+namespace rpp
+{
+
+struct pp_file_profile {
+    int includes;               // number of times the file was preprocessed
+    int skipped;                // #includes of it skipped as it was guarded or #pragma once
+    int depth;                  // smallest include depth, the main file is at 0
+    std::size_t bytes_read;
+    std::size_t bytes_emitted;  // not counting the files it includes
+    double time;                // seconds, not counting the files it includes
+    double total_time;
+
+    pp_file_profile():
+            includes(0), skipped(0), depth(-1), bytes_read(0), bytes_emitted(0), time(0), total_time(0) {}
+};
+
+struct pp_macro_profile {
+    int expansions;
+    std::size_t generated_bytes;
+
+    pp_macro_profile():
+            expansions(0), generated_bytes(0) {}
+};
+
+/* Where the preprocessor spends its time. Set on a pp_environment, it
+ * is told about every file preprocessed through pp::file(), every
+ * #include skipped as the file was guarded, and every macro expansion. Bytes emitted are only known when the output goes to
+ * a pp_output_iterator. A profile must not be shared between threads.
+ */
+class pp_profile
+{
+public:
+    typedef std::map<std::string, pp_file_profile> file_map;
+    typedef std::map<std::string, pp_macro_profile> macro_map;
+
+    inline file_map const &files() const {
+        return _M_files;
+    }
+
+    inline macro_map const &macros() const {
+        return _M_macros;
+    }
+
+    void enter_file(std::string const &__filename, std::size_t __bytes_read, std::size_t __output_size) {
+        pp_file_profile &__file = _M_files[__filename];
+        int __depth = int(_M_stack.size());
+        if (__file.depth < 0 || __depth < __file.depth)
+            __file.depth = __depth;
+        ++__file.includes;
+        __file.bytes_read += __bytes_read;
+
+        frame __frame;
+        __frame.file = &__file;
+        __frame.start = now();
+        __frame.child_time = 0;
+        __frame.output_start = __output_size;
+        __frame.child_output = 0;
+        _M_stack.push_back(__frame);
+    }
+
+    // an #include of the file that didn't open it again
+    void include_skipped(std::string const &__filename) {
+        pp_file_profile &__file = _M_files[__filename];
+        int __depth = int(_M_stack.size());
+        if (__file.depth < 0 || __depth < __file.depth)
+            __file.depth = __depth;
+        ++__file.skipped;
+    }
+
+    void leave_file(std::size_t __output_size) {
+        frame const __frame = _M_stack.back();
+        _M_stack.pop_back();
+
+        double const __elapsed = now() - __frame.start;
+        std::size_t const __emitted = __output_size - __frame.output_start;
+        __frame.file->total_time += __elapsed;
+        __frame.file->time += __elapsed - __frame.child_time;
+        __frame.file->bytes_emitted += __emitted - __frame.child_output;
+
+        if (! _M_stack.empty()) {
+            _M_stack.back().child_time += __elapsed;
+            _M_stack.back().child_output += __emitted;
+        }
+    }
+
+    inline void macro_expanded(pp_fast_string const &__name, std::size_t __generated_bytes) {
+        pp_macro_profile &__macro = _M_macros[std::string(__name.begin(), __name.size())];
+        ++__macro.expansions;
+        __macro.generated_bytes += __generated_bytes;
+    }
+
+    void write_json(std::ostream &__out, std::size_t __symbol_count = 0) const {
+        __out << "{\n  \"symbols\": " << __symbol_count << ",\n  \"files\": [";
+        for (file_map::const_iterator it = _M_files.begin(); it != _M_files.end(); ++it) {
+            __out << (it == _M_files.begin() ? "\n    " : ",\n    ") << "{\"file\": ";
+            write_json_string(__out, it->first);
+            __out << ", \"includes\": " << it->second.includes
+                  << ", \"skipped\": " << it->second.skipped
+                  << ", \"depth\": " << it->second.depth
+                  << ", \"bytes_read\": " << it->second.bytes_read
+                  << ", \"bytes_emitted\": " << it->second.bytes_emitted
+                  << ", \"time\": " << it->second.time
+                  << ", \"total_time\": " << it->second.total_time << "}";
+        }
+        __out << "\n  ],\n  \"macros\": [";
+        for (macro_map::const_iterator it = _M_macros.begin(); it != _M_macros.end(); ++it) {
+            __out << (it == _M_macros.begin() ? "\n    " : ",\n    ") << "{\"macro\": ";
+            write_json_string(__out, it->first);
+            __out << ", \"expansions\": " << it->second.expansions
+                  << ", \"generated_bytes\": " << it->second.generated_bytes << "}";
+        }
+        __out << "\n  ]\n}\n";
+    }
+
+    // wall clock, in seconds
+    static double now() {
+#if defined (PP_OS_WIN)
+        LARGE_INTEGER __frequency, __counter;
+        QueryPerformanceFrequency(&__frequency);
+        QueryPerformanceCounter(&__counter);
+        return double(__counter.QuadPart) / double(__frequency.QuadPart);
+#else
+        struct timeval __tv;
+        gettimeofday(&__tv, 0);
+        return __tv.tv_sec + __tv.tv_usec / 1e6;
+#endif
+    }
+
+private:
+    struct frame {
+        pp_file_profile *file;
+        double start;
+        double child_time;
+        std::size_t output_start;
+        std::size_t child_output;
+    };
+
+    static void write_json_string(std::ostream &__out, std::string const &__s) {
+        __out << '"';
+        for (std::string::const_iterator it = __s.begin(); it != __s.end(); ++it) {
+            if (*it == '"' || *it == '\\') {
+                __out << '\\' << *it;
+            } else if ((unsigned char) *it < 0x20) {
+                char __buffer[8];
+                pp_snprintf(__buffer, sizeof(__buffer), "\\u%04x", (unsigned char) *it);
+                __out << __buffer;
+            } else {
+                __out << *it;
+            }
+        }
+        __out << '"';
+    }
+
+private:
+    file_map _M_files;
+    macro_map _M_macros;
+    std::vector<frame> _M_stack;
+};
+
+} // namespace rpp
+
+#endif // PP_PROFILE_H
+
+// kate: space-indent on; indent-width 2; replace-tabs on;
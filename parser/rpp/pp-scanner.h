@@ -27,10 +27,79 @@
 
 #include "pp-cctype.h"
 #include <cassert>
+#include <cstring>
+
+#if defined (__SSE2__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define PP_HAVE_SSE2
+#  include <emmintrin.h>
+#  if defined (_MSC_VER)
+#    include <intrin.h>
+#  endif
+#endif
 
 namespace rpp
 {
 
+/* Returns the first position in [__first, __last) holding one of the
+ * characters of __set. Comments, string literals and skipped lines are
+ * mostly made of bytes nobody is interested in, so plain character
+ * buffers are searched 16 bytes at a time where SSE2 is available.
+ */
+template <typename _InputIterator, int _Size>
+inline _InputIterator pp_find_any(_InputIterator __first, _InputIterator __last, char const (&__set)[_Size])
+{
+    for (; __first != __last; ++__first) {
+        for (int i = 0; i < _Size - 1; ++i) {
+            if (*__first == __set[i])
+                return __first;
+        }
+    }
+
+    return __first;
+}
+
+template <int _Size>
+inline char const *pp_find_any(char const *__first, char const *__last, char const (&__set)[_Size])
+{
+#if defined (PP_HAVE_SSE2)
+    __m128i __needles[_Size - 1];
+    for (int i = 0; i < _Size - 1; ++i)
+        __needles[i] = _mm_set1_epi8(__set[i]);
+
+    for (; __last - __first >= 16; __first += 16) {
+        __m128i const __chunk = _mm_loadu_si128(reinterpret_cast<__m128i const *>(__first));
+        __m128i __match = _mm_cmpeq_epi8(__chunk, __needles[0]);
+        for (int i = 1; i < _Size - 1; ++i)
+            __match = _mm_or_si128(__match, _mm_cmpeq_epi8(__chunk, __needles[i]));
+
+        if (unsigned int __mask = _mm_movemask_epi8(__match)) {
+#  if defined (_MSC_VER)
+            unsigned long __index;
+            _BitScanForward(&__index, __mask);
+            return __first + __index;
+#  else
+            return __first + __builtin_ctz(__mask);
+#  endif
+        }
+    }
+#endif
+
+    for (; __first != __last; ++__first) {
+        for (int i = 0; i < _Size - 1; ++i) {
+            if (*__first == __set[i])
+                return __first;
+        }
+    }
+
+    return __first;
+}
+
+template <int _Size>
+inline char *pp_find_any(char *__first, char *__last, char const (&__set)[_Size])
+{
+    return const_cast<char *>(pp_find_any(const_cast<char const *>(__first), const_cast<char const *>(__last), __set));
+}
+
 struct pp_skip_blanks {
     int lines;
 
@@ -133,6 +202,46 @@ struct pp_skip_comment_or_divop {
 
         return __first;
     }
+
+    char const *operator()(char const *__first, char const *__last) {
+        lines = 0;
+
+        if (__first == __last || *__first != '/')
+            return __first;
+
+        if (++__first == __last)
+            return __first;
+
+        if (*__first == '/') {
+            char const *__end = static_cast<char const *>(std::memchr(__first, '\n', __last - __first));
+            return __end ? __end : __last;
+        } else if (*__first != '*') {
+            return __first;
+        }
+
+        for (++__first; ; ) {
+            __first = pp_find_any(__first, __last, "*\n");
+            if (__first == __last)
+                return __first;
+
+            if (*__first++ == '\n') {
+                ++lines;
+                continue;
+            }
+
+            while (__first != __last && *__first == '*')
+                ++__first;
+
+            if (__first == __last)
+                return __first;
+            else if (*__first == '/')
+                return ++__first;
+        }
+    }
+
+    char *operator()(char *__first, char *__last) {
+        return const_cast<char *>(operator()(const_cast<char const *>(__first), const_cast<char const *>(__last)));
+    }
 };
 
 struct pp_skip_identifier {
@@ -213,6 +322,40 @@ struct pp_skip_string_literal {
 
         return __first;
     }
+
+    char const *operator()(char const *__first, char const *__last) {
+        lines = 0;
+
+        if (__first == __last || *__first != '\"')
+            return __first;
+
+        for (++__first; ; ) {
+            __first = pp_find_any(__first, __last, "\"\\\n");
+            if (__first == __last)
+                return __first;
+
+            switch (*__first++) {
+            case '\"':
+                return __first;
+
+            case '\n':
+                assert(0);
+                ++lines;
+                break;
+
+            default: // an escape sequence
+                if (__first == __last)
+                    return __first;
+                if (*__first++ == '\n')
+                    ++lines;
+                break;
+            }
+        }
+    }
+
+    char *operator()(char *__first, char *__last) {
+        return const_cast<char *>(operator()(const_cast<char const *>(__first), const_cast<char const *>(__last)));
+    }
 };
 
 struct pp_skip_char_literal {
@@ -36,16 +36,17 @@ class pp_string
 
     _CharT const *_M_begin;
     std::size_t _M_size;
+    mutable std::size_t _M_hash; // 0 until computed
 
 public:
     inline pp_string():
-            _M_begin(0), _M_size(0) {}
+            _M_begin(0), _M_size(0), _M_hash(0) {}
 
     explicit pp_string(std::string const &__s):
-            _M_begin(__s.c_str()), _M_size(__s.size()) {}
+            _M_begin(__s.c_str()), _M_size(__s.size()), _M_hash(0) {}
 
     inline pp_string(_CharT const *__begin, std::size_t __size):
-            _M_begin(__begin), _M_size(__size) {}
+            _M_begin(__begin), _M_size(__size), _M_hash(0) {}
 
     inline _CharT const *begin() const {
         return _M_begin;
@@ -62,6 +63,17 @@ public:
         return _M_size;
     }
 
+    // computed on first use, interned strings (see pp_symbol_table) pay for it once
+    inline std::size_t hash() const {
+        if (! _M_hash) {
+            std::size_t __h = 0;
+            for (std::size_t i = 0; i < _M_size; ++i)
+                __h = (__h << 5) - __h + _M_begin[i];
+            _M_hash = __h ? __h : 1;
+        }
+        return _M_hash;
+    }
+
     inline int compare(pp_string const &__other) const {
         size_type const __size = this->size();
         size_type const __osize = __other.size();
@@ -75,11 +87,13 @@ public:
     }
 
     inline bool operator == (pp_string const &__other) const {
-        return compare(__other) == 0;
+        return _M_size == __other._M_size
+               && (_M_begin == __other._M_begin
+                   || ! traits_type::compare(_M_begin, __other._M_begin, _M_size));
     }
 
     inline bool operator != (pp_string const &__other) const {
-        return compare(__other) != 0;
+        return ! operator == (__other);
     }
 
     inline bool operator < (pp_string const &__other) const {
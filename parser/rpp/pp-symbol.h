@@ -33,56 +33,165 @@
 namespace rpp
 {
 
-class pp_symbol
+class pp_mutex
 {
-    static rxx_allocator<char> &allocator_instance() {
-        static rxx_allocator<char>__allocator;
-        return __allocator;
+public:
+#if defined (PP_OS_WIN)
+    pp_mutex() { InitializeCriticalSection(&_M_mutex); }
+    ~pp_mutex() { DeleteCriticalSection(&_M_mutex); }
+
+    inline void lock() { EnterCriticalSection(&_M_mutex); }
+    inline void unlock() { LeaveCriticalSection(&_M_mutex); }
+
+private:
+    CRITICAL_SECTION _M_mutex;
+#else
+    pp_mutex() { pthread_mutex_init(&_M_mutex, 0); }
+    ~pp_mutex() { pthread_mutex_destroy(&_M_mutex); }
+
+    inline void lock() { pthread_mutex_lock(&_M_mutex); }
+    inline void unlock() { pthread_mutex_unlock(&_M_mutex); }
+
+private:
+    pthread_mutex_t _M_mutex;
+#endif
+
+    pp_mutex(pp_mutex const &);
+    pp_mutex &operator=(pp_mutex const &);
+};
+
+class pp_mutex_locker
+{
+public:
+    explicit pp_mutex_locker(pp_mutex &__mutex): _M_mutex(__mutex) {
+        _M_mutex.lock();
     }
-    static rxx_allocator<pp_fast_string> &ppfs_allocator_instance ()
-    {
-        static rxx_allocator<pp_fast_string>__ppfs_allocator;
-        return __ppfs_allocator;
+    ~pp_mutex_locker() {
+        _M_mutex.unlock();
     }
 
+private:
+    pp_mutex &_M_mutex;
+};
+
+/* Interns the names, formals and definitions of the macros of a
+ * pp_environment. Identical strings are stored once, and everything is
+ * released together with the table. The table may be shared by
+ * preprocessors running on different threads.
+ */
+class pp_symbol_table
+{
 public:
-    static int &N() {
-        static int __N;
-        return __N;
+    pp_symbol_table():
+            _M_slots(0),
+            _M_mask(INITIAL_SIZE - 1),
+            _M_count(0) {
+        _M_slots = new pp_fast_string const *[INITIAL_SIZE];
+        memset(_M_slots, 0, INITIAL_SIZE * sizeof(pp_fast_string const *));
+    }
+
+    ~pp_symbol_table() {
+        delete [] _M_slots;
     }
 
-    static pp_fast_string const *get(char const *__data, std::size_t __size) {
-        ++N();
-        char *data = allocator_instance().allocate(__size + 1);
-        memcpy(data, __data, __size);
-        data[__size] = '\0';
+    inline std::size_t count() const {
+        return _M_count;
+    }
+
+    pp_fast_string const *get(char const *__data, std::size_t __size) {
+        pp_fast_string const __key(__data, __size);
+        std::size_t const __hash = __key.hash();
+
+        pp_mutex_locker __locker(_M_mutex);
+        std::size_t __index = find_slot(__key, __hash);
+        if (! _M_slots[__index]) {
+            char *data = _M_allocator.allocate(__size + 1);
+            memcpy(data, __data, __size);
+            data[__size] = '\0';
+
+            pp_fast_string *where = _M_ppfs_allocator.allocate(1, strideof(pp_fast_string));
+            pp_fast_string *__symbol = new(where) pp_fast_string(data, __size);
+            __symbol->hash(); // computed before any other thread can see it
+
+            _M_slots[__index] = __symbol;
+            if (++_M_count * 2 > _M_mask + 1)
+                grow();
+            return __symbol;
+        }
 
-        pp_fast_string *where = ppfs_allocator_instance ().allocate (sizeof (pp_fast_string));
-        return new(where) pp_fast_string(data, __size);
+        return _M_slots[__index];
     }
 
     template <typename _InputIterator>
-    static pp_fast_string const *get(_InputIterator __first, _InputIterator __last) {
-        ++N();
+    pp_fast_string const *get(_InputIterator __first, _InputIterator __last) {
         std::ptrdiff_t __size;
 #if defined(__SUNPRO_CC)
         std::distance(__first, __last, __size);
 #else
         __size = std::distance(__first, __last);
 #endif
-        assert(__size >= 0 && __size < 512);
+        assert(__size >= 0);
 
-        char *data = allocator_instance().allocate(__size + 1);
-        std::copy(__first, __last, data);
-        data[__size] = '\0';
+        // most names fit on the stack, longer ones are copied to the heap
+        char __buffer[512];
+        if (__size > (std::ptrdiff_t) sizeof(__buffer))
+            return get(std::string(__first, __last));
 
-        pp_fast_string *where = ppfs_allocator_instance ().allocate (sizeof (pp_fast_string));
-        return new(where) pp_fast_string(data, __size);
+        std::copy(__first, __last, __buffer);
+        return get(__buffer, __size);
     }
 
-    static pp_fast_string const *get(std::string const &__s) {
+    pp_fast_string const *get(std::string const &__s) {
         return get(__s.c_str(), __s.size());
     }
+
+private:
+    enum { INITIAL_SIZE = 4096 };
+
+    inline std::size_t home_slot(std::size_t __hash) const {
+        return (__hash ^ (__hash >> 15)) & _M_mask;
+    }
+
+    inline std::size_t find_slot(pp_fast_string const &__s, std::size_t __hash) const {
+        std::size_t __index = home_slot(__hash);
+        while (_M_slots[__index]
+               && (_M_slots[__index]->hash() != __hash || *_M_slots[__index] != __s))
+            __index = (__index + 1) & _M_mask;
+        return __index;
+    }
+
+    void grow() {
+        pp_fast_string const **__old = _M_slots;
+        std::size_t __old_size = _M_mask + 1;
+
+        _M_mask = (__old_size << 1) - 1;
+        _M_slots = new pp_fast_string const *[_M_mask + 1];
+        memset(_M_slots, 0, (_M_mask + 1) * sizeof(pp_fast_string const *));
+
+        for (std::size_t i = 0; i < __old_size; ++i) {
+            if (! __old[i])
+                continue;
+
+            std::size_t __index = home_slot(__old[i]->hash());
+            while (_M_slots[__index])
+                __index = (__index + 1) & _M_mask;
+            _M_slots[__index] = __old[i];
+        }
+
+        delete [] __old;
+    }
+
+private:
+    pp_symbol_table(pp_symbol_table const &);
+    pp_symbol_table &operator=(pp_symbol_table const &);
+
+private:
+    pp_mutex _M_mutex;
+    rxx_allocator<char> _M_allocator;
+    rxx_allocator<pp_fast_string> _M_ppfs_allocator;
+    pp_fast_string const **_M_slots;
+    std::size_t _M_mask;
+    std::size_t _M_count;
 };
 
 } // namespace rpp
@@ -39,6 +39,8 @@
 #include <cassert>
 #include <cctype>
 #include <cstdio>
+#include <cstdlib>
+#include <fstream>
 
 #include <fcntl.h>
 
@@ -49,6 +51,16 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 
+#if defined (PP_OS_WIN)
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <windows.h>
+#else
+#  include <dirent.h>
+#  include <pthread.h>
+#endif
+
 #if (_MSC_VER >= 1400)
 #  define FILENO _fileno
 #else
@@ -80,7 +92,9 @@
 #include "pp-internal.h"
 #include "pp-iterator.h"
 #include "pp-macro.h"
+#include "pp-profile.h"
 #include "pp-environment.h"
+#include "pp-cache.h"
 #include "pp-scanner.h"
 #include "pp-macro-expander.h"
 #include "pp-engine.h"
@@ -25,4 +25,131 @@
 
 #include "smallobject.h"
 
+#include <cstdlib>
+#include <new>
+
+struct pool::block {
+    block *next;
+    std::size_t size;
+
+    // the memory of a block follows it, aligned for any node
+    enum { header_size = (sizeof(block *) + sizeof(std::size_t) + 15) & ~15 };
+
+    inline char *data() {
+        return reinterpret_cast<char *>(this) + header_size;
+    }
+};
+
+pool::pool(std::size_t __block_size)
+        : _M_first(0),
+        _M_current(0),
+        _M_top(0),
+        _M_end(0),
+        _M_block_size(__block_size),
+        _M_reserved(0)
+{
+    std::memset(_M_node_counts, 0, sizeof(_M_node_counts));
+    std::memset(_M_node_bytes, 0, sizeof(_M_node_bytes));
+}
+
+pool::~pool()
+{
+    while (_M_first) {
+        block *__next = _M_first->next;
+        ::free(_M_first);
+        _M_first = __next;
+    }
+}
+
+void *pool::allocate_block(std::size_t __size)
+{
+    // the blocks after the current one were released by a reset
+    block *__next = _M_current ? _M_current->next : _M_first;
+
+    if (!__next || __next->size < __size) {
+        std::size_t __block_size = _M_block_size;
+        if (_M_block_size < std::size_t(max_block_size))
+            _M_block_size *= 2;
+        if (__block_size < __size)
+            __block_size = __size;
+
+        block *__block = static_cast<block *>(::malloc(block::header_size + __block_size));
+        if (!__block)
+            throw std::bad_alloc();
+
+        __block->size = __block_size;
+        __block->next = __next;
+        if (_M_current)
+            _M_current->next = __block;
+        else
+            _M_first = __block;
+        _M_reserved += __block_size;
+        __next = __block;
+    }
+
+    _M_current = __next;
+    _M_top = __next->data() + __size;
+    _M_end = __next->data() + __next->size;
+
+    return __next->data();
+}
+
+void pool::reset(const mark_type &__mark)
+{
+    _M_current = __mark._M_block ? __mark._M_block : _M_first;
+    if (!_M_current)
+        return;
+
+    _M_top = __mark._M_block ? __mark._M_top : _M_current->data();
+    _M_end = _M_current->data() + _M_current->size;
+}
+
+void pool::splice(pool &__other)
+{
+    if (__other._M_current) {
+        // the blocks released in the other pool are of no use here
+        block *__spare = __other._M_current->next;
+        while (__spare) {
+            block *__next = __spare->next;
+            __other._M_reserved -= __spare->size;
+            ::free(__spare);
+            __spare = __next;
+        }
+
+        __other._M_current->next = _M_first;
+        _M_first = __other._M_first;
+        _M_reserved += __other._M_reserved;
+        if (!_M_current) {
+            _M_current = __other._M_current;
+            _M_top = __other._M_top;
+            _M_end = __other._M_end;
+        }
+    }
+
+    for (int __kind = 0; __kind < max_node_kinds; ++__kind) {
+        _M_node_counts[__kind] += __other._M_node_counts[__kind];
+        _M_node_bytes[__kind] += __other._M_node_bytes[__kind];
+    }
+
+    __other._M_first = 0;
+    __other._M_current = 0;
+    __other._M_top = 0;
+    __other._M_end = 0;
+    __other._M_reserved = 0;
+    std::memset(__other._M_node_counts, 0, sizeof(__other._M_node_counts));
+    std::memset(__other._M_node_bytes, 0, sizeof(__other._M_node_bytes));
+}
+
+std::size_t pool::used() const
+{
+    if (!_M_current)
+        return 0;
+
+    std::size_t __used = _M_top - _M_current->data();
+    for (block *__block = _M_first; __block != _M_current; __block = __block->next)
+        __used += __block->size;
+
+    return __used;
+}
+
 // kate: space-indent on; indent-width 2; replace-tabs on;
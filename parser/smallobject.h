@@ -27,25 +27,132 @@
 #define SMALLOBJECT_H
 
 #include "rxx_allocator.h"
+
+#include <cassert>
+#include <cstddef>
 #include <cstring>
 
+/**
+*   The memory of a parse. Nodes are carved out of blocks, and are only
+*   given back all at once: when the pool goes away, or when it is reset
+*   to a mark, which releases what was allocated after the mark. Blocks
+*   are kept when released, and reused by the allocations that follow.
+*
+*   The first block has the size the pool is made with, each new block is
+*   twice the previous one up to 2MB, the size of a huge page, so a large
+*   parse takes few blocks. Memory isn't cleared: CreateNode() clears the
+*   nodes it makes, list nodes are written in full.
+*
+*   CreateNode() also counts the nodes it makes and their bytes by kind.
+*   The counts are of everything allocated, a reset doesn't take them back.
+*/
 class pool
 {
-    rxx_allocator<char> __alloc;
-
 public:
+    enum { max_block_size = 2 << 20, max_node_kinds = 128 };
+
+    struct block;
+
+    struct mark_type {
+        inline mark_type(): _M_block(0), _M_top(0) {}
+
+    private:
+        block *_M_block;
+        char *_M_top;
+
+        friend class pool;
+    };
+
+    explicit pool(std::size_t __block_size = 1 << 16);
+    ~pool();
+
     inline void *allocate(std::size_t __size);
     inline void *allocate(std::size_t __size, std::size_t __stride);
+
+    inline mark_type mark() const;
+
+    // releases what was allocated after the mark
+    void reset(const mark_type &__mark);
+
+    // releases everything
+    inline void clear() {
+        reset(mark_type());
+    }
+
+    /**
+    *   Takes the memory allocated from \a __other, which is left empty. Its
+    *   blocks go before those of this pool, and are not released by a reset
+    *   to a mark of this pool, only by clear().
+    */
+    void splice(pool &__other);
+
+    // bytes allocated and not released, and bytes held in blocks
+    std::size_t used() const;
+    inline std::size_t reserved() const {
+        return _M_reserved;
+    }
+
+    inline void count_node(int __kind, std::size_t __size) {
+        assert(__kind >= 0 && __kind < max_node_kinds);
+        ++_M_node_counts[__kind];
+        _M_node_bytes[__kind] += __size;
+    }
+
+    inline std::size_t node_count(int __kind) const {
+        return _M_node_counts[__kind];
+    }
+
+    inline std::size_t node_bytes(int __kind) const {
+        return _M_node_bytes[__kind];
+    }
+
+private:
+    void *allocate_block(std::size_t __size);
+
+    block *_M_first;
+    block *_M_current;
+    char *_M_top;
+    char *_M_end;
+    std::size_t _M_block_size;
+    std::size_t _M_reserved;
+    std::size_t _M_node_counts[max_node_kinds];
+    std::size_t _M_node_bytes[max_node_kinds];
+
+private:
+    pool(const pool &);
+    void operator = (const pool &);
 };
 
 inline void *pool::allocate(std::size_t __size)
 {
-    return __alloc.allocate(__size);
+    if (__size > std::size_t(_M_end - _M_top))
+        return allocate_block(__size);
+
+    void *__p = _M_top;
+    _M_top += __size;
+    return __p;
 }
 
 inline void *pool::allocate(std::size_t __size, std::size_t __stride)
 {
-  return __alloc.allocate(__size, __stride);
+    std::size_t __misalignment = reinterpret_cast<std::size_t>(_M_top) % __stride;
+    std::size_t __padding = __misalignment ? __stride - __misalignment : 0;
+
+    // new blocks start aligned on any stride
+    if (__padding + __size > std::size_t(_M_end - _M_top))
+        return allocate_block(__size);
+
+    void *__p = _M_top + __padding;
+    _M_top += __padding + __size;
+    return __p;
+}
+
+inline pool::mark_type pool::mark() const
+{
+    mark_type __mark;
+    __mark._M_block = _M_current;
+    __mark._M_top = _M_top;
+    return __mark;
 }
 
 #endif
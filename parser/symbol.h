@@ -27,15 +27,16 @@
 #define SYMBOL_H
 
 #include <QtCore/QString>
+#include <algorithm>
+#include <cstdlib>
 #include <cstring>
-
-#include <QtCore/QHash>
-#include <QtCore/QPair>
+#include <new>
 
 struct NameSymbol
 {
     const char *data;
     std::size_t count;
+    uint hash;
 
     inline QString as_string() const
     {
@@ -50,8 +51,8 @@ struct NameSymbol
 
 protected:
     inline NameSymbol() {}
-    inline NameSymbol(const char *d, std::size_t c)
-            : data(d), count(c) {}
+    inline NameSymbol(const char *d, std::size_t c, uint h)
+            : data(d), count(c), hash(h) {}
 
 private:
     void operator = (const NameSymbol &);
@@ -61,55 +62,138 @@ private:
 
 inline uint qHash(const NameSymbol &r)
 {
-    uint hash_value = 0;
-
-    for (std::size_t i = 0; i < r.count; ++i)
-        hash_value = (hash_value << 5) - hash_value + r.data[i];
-
-    return hash_value;
-}
-
-inline uint qHash(const QPair<const char*, std::size_t> &r)
-{
-    uint hash_value = 0;
-
-    for (std::size_t i = 0; i < r.second; ++i)
-        hash_value = (hash_value << 5) - hash_value + r.first[i];
-
-    return hash_value;
+    return r.hash;
 }
 
+/**
+*   Interns names, equal names share a NameSymbol. The symbols are carved
+*   from blocks owned by the table, and found through an open-addressed
+*   table of pointers to them by the hash each symbol keeps. The names
+*   aren't copied, they must outlive the table.
+*/
 class NameTable
 {
 public:
-    typedef QPair<const char *, std::size_t> KeyType;
-    typedef QHash<KeyType, NameSymbol*> ContainerType;
-
-public:
-    NameTable() {}
+    explicit NameTable(std::size_t capacity = 1 << 12)
+            : _M_slots(0), _M_capacity(1), _M_count(0), _M_blocks(0)
+    {
+        while (_M_capacity < capacity)
+            _M_capacity <<= 1;
+    }
 
     ~NameTable()
     {
-        qDeleteAll(_M_storage);
+        delete[] _M_slots;
+
+        for (Block *block = _M_blocks; block; ) {
+            Block *next = block->next;
+            ::free(block);
+            block = next;
+        }
+    }
+
+    static inline uint hash(const char *str, std::size_t len)
+    {
+        uint hash_value = 0;
+
+        for (std::size_t i = 0; i < len; ++i)
+            hash_value = (hash_value << 5) - hash_value + str[i];
+
+        return hash_value;
     }
 
     inline const NameSymbol *findOrInsert(const char *str, std::size_t len)
     {
-        KeyType key(str, len);
+        uint h = hash(str, len);
 
-        NameSymbol *name = _M_storage.value(key);
-        if (!name) {
-            name = new NameSymbol(str, len);
-            _M_storage.insert(key, name);
-        }
+        if (!_M_slots || (_M_count + 1) * 4 > _M_capacity * 3)
+            grow();
 
-        return name;
+        std::size_t mask = _M_capacity - 1;
+        for (std::size_t i = slot(h); ; i = (i + 1) & mask) {
+            NameSymbol *name = _M_slots[i];
+
+            if (!name) {
+                name = allocate(str, len, h);
+                _M_slots[i] = name;
+                ++_M_count;
+                return name;
+            }
+
+            if (name->hash == h && name->count == len && !std::memcmp(name->data, str, len))
+                return name;
+        }
     }
 
-    inline std::size_t count() const { return _M_storage.size(); }
+    inline std::size_t count() const { return _M_count; }
 
 private:
-    ContainerType _M_storage;
+    struct Block {
+        Block *next;
+        std::size_t used;
+        std::size_t size;
+        char *data;
+    };
+
+    enum { BlockSize = 1 << 16 };
+
+    inline std::size_t slot(uint h) const
+    {
+        return (h ^ (h >> 16)) & (_M_capacity - 1);
+    }
+
+    void grow()
+    {
+        std::size_t capacity = _M_slots ? _M_capacity * 2 : _M_capacity;
+        NameSymbol **slots = new NameSymbol *[capacity];
+        std::memset(slots, 0, capacity * sizeof(NameSymbol *));
+
+        std::size_t old_capacity = _M_capacity;
+        _M_capacity = capacity;
+        if (_M_slots) {
+            for (std::size_t i = 0; i < old_capacity; ++i) {
+                if (NameSymbol *name = _M_slots[i]) {
+                    std::size_t j = slot(name->hash);
+                    while (slots[j])
+                        j = (j + 1) & (capacity - 1);
+                    slots[j] = name;
+                }
+            }
+            delete[] _M_slots;
+        }
+        _M_slots = slots;
+    }
+
+    // bump allocation from the current block
+    void *allocate(std::size_t size)
+    {
+        size = (size + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+
+        Block *block = _M_blocks;
+        if (!block || block->used + size > block->size) {
+            std::size_t block_size = std::max(std::size_t(BlockSize), size);
+            block = (Block *) ::malloc(sizeof(Block) + block_size);
+            block->used = 0;
+            block->size = block_size;
+            block->data = (char *) (block + 1);
+            block->next = _M_blocks;
+            _M_blocks = block;
+        }
+
+        void *result = block->data + block->used;
+        block->used += size;
+        return result;
+    }
+
+    NameSymbol *allocate(const char *str, std::size_t len, uint h)
+    {
+        return new (allocate(sizeof(NameSymbol))) NameSymbol(str, len, h);
+    }
+
+    NameSymbol **_M_slots;
+    std::size_t _M_capacity;
+    std::size_t _M_count;
+    Block *_M_blocks;
 
 private:
     NameTable(const NameTable &other);
@@ -131,7 +131,8 @@ static char const * const _S_token_names[] = {
     "whitespaces",
     "xor",
     "xor_eq",
-    "Q_ENUMS"
+    "Q_ENUMS",
+    "Q_INVOKABLE"
 };
 
 static char _S_printable[][2] = {
@@ -201,6 +201,45 @@ void TestAbstractMetaType::testObjectTypeUsedAsValue()
     QVERIFY(metaType->typeEntry()->isObject());
 }
 
+void TestAbstractMetaType::testTypeCache()
+{
+    const char* cppCode ="\
+    struct A {\
+        void method(const A& a, int b);\
+        void method(const A& a, A* b);\
+        const A& other(const A& a);\
+    };\
+    ";
+    const char* xmlCode = "<typesystem package='Foo'>\
+    <primitive-type name='int' />\
+    <value-type name='A' />\
+    </typesystem>";
+    TestUtil t(cppCode, xmlCode);
+
+    AbstractMetaClass* classA = t.builder()->classes().findClass("A");
+    QVERIFY(classA);
+    AbstractMetaFunctionList overloads = classA->queryFunctionsByName("method");
+    QCOMPARE(overloads.count(), 2);
+    AbstractMetaType* first = overloads.at(0)->arguments().first()->type();
+    AbstractMetaType* second = overloads.at(1)->arguments().first()->type();
+    AbstractMetaType* returned = classA->queryFunctionsByName("other").first()->type();
+
+    // each function owns a type of its own, alike
+    QVERIFY(first != second);
+    QVERIFY(first != returned);
+    QCOMPARE(first->cppSignature(), QString("const A &"));
+    QCOMPARE(second->cppSignature(), first->cppSignature());
+    QCOMPARE(returned->cppSignature(), first->cppSignature());
+    QCOMPARE(second->typeUsagePattern(), first->typeUsagePattern());
+    QCOMPARE(overloads.at(1)->arguments().last()->type()->cppSignature(), QString("A *"));
+
+    if (qgetenv("APIEXTRACTOR_NO_TYPE_CACHE").isEmpty())
+        QVERIFY(t.builder()->typeCacheHits() > 0);
+    else
+        QCOMPARE(t.builder()->typeCacheHits(), 0);
+    QVERIFY(t.builder()->typeCacheMisses() > 0);
+}
+
 QTEST_APPLESS_MAIN(TestAbstractMetaType)
 
 #include "testabstractmetatype.moc"
@@ -37,6 +37,7 @@ private slots:
     void testApiVersionSupported();
     void testApiVersionNotSupported();
     void testObjectTypeUsedAsValue();
+    void testTypeCache();
 };
 
 #endif
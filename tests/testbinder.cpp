@@ -0,0 +1,167 @@
+/*
+* This file is part of the API Extractor project.
+*
+* Copyright (C) 2009 Nokia Corporation and/or its subsidiary(-ies).
+*
+* Contact: PySide team <contact@pyside.org>
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* version 2 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+* 02110-1301 USA
+*
+*/
+
+
+
+#include "testbinder.h"
+#include <QtTest/QTest>
+#include "parser/binder.h"
+#include "parser/codemodel.h"
+#include "parser/control.h"
+#include "parser/parser.h"
+
+static FileModelItem bind(const char *code, CodeModel *model, std::size_t *indexed = 0, std::size_t *walks = 0)
+{
+    Control control;
+    Parser parser(&control);
+    pool p;
+    TranslationUnitAST *ast = parser.parse(code, qstrlen(code), &p);
+
+    Binder binder(model, parser.location());
+    FileModelItem dom = binder.run(ast);
+    if (indexed)
+        *indexed = binder.indexedScopeLookups();
+    if (walks)
+        *walks = binder.scopeWalks();
+    return dom;
+}
+
+static QStringList functionType(ClassModelItem klass, const QString &name)
+{
+    return klass->findFunctions(name).first()->type().qualifiedName();
+}
+
+void TestBinder::testQualifyTypeFromBaseClasses()
+{
+    const char* code = "\
+    struct Base { struct Inner {}; };\n\
+    struct Derived : Base {\n\
+        Inner f();\n\
+        struct Nested { Inner g(); };\n\
+    };\n";
+
+    CodeModel model;
+    std::size_t indexed;
+    std::size_t walks;
+    FileModelItem dom = bind(code, &model, &indexed, &walks);
+
+    ClassModelItem derived = dom->findClass("Derived");
+    QVERIFY(derived);
+    QCOMPARE(functionType(derived, "f"), QStringList() << "Base" << "Inner");
+    ClassModelItem nested = derived->findClass("Nested");
+    QVERIFY(nested);
+    QCOMPARE(functionType(nested, "g"), QStringList() << "Base" << "Inner");
+
+    // the classes are in the index, the model isn't walked
+    QVERIFY(indexed > 0);
+    QCOMPARE(walks, std::size_t(0));
+}
+
+void TestBinder::testScopesInFirstNamespaceBlock()
+{
+    // a namespace is only found once its first block ends, so are the
+    // classes in it, and their base classes are only looked at then
+    const char* code = "\
+    struct Base { struct Inner {}; };\n\
+    namespace N { struct Derived : Base { Inner f(); }; }\n\
+    namespace N { struct Other : Base { Inner g(); }; }\n";
+
+    CodeModel model;
+    std::size_t indexed;
+    std::size_t walks;
+    FileModelItem dom = bind(code, &model, &indexed, &walks);
+
+    NamespaceModelItem ns = dom->findNamespace("N");
+    QVERIFY(ns);
+    QCOMPARE(ns->classes().size(), 2);
+    ClassModelItem derived = ns->findClass("Derived");
+    QVERIFY(derived);
+    QCOMPARE(functionType(derived, "f"), QStringList() << "Base" << "Inner");
+    ClassModelItem other = ns->findClass("Other");
+    QVERIFY(other);
+    QCOMPARE(functionType(other, "g"), QStringList() << "Base" << "Inner");
+    QVERIFY(walks > 0);
+    QVERIFY(indexed > 0);
+}
+
+void TestBinder::testInternedNames()
+{
+    const char* code = "\
+    namespace N {\n\
+        struct A { void f(int); void f(double); int g; };\n\
+        void f(int);\n\
+    }\n";
+
+    CodeModel model;
+    FileModelItem dom = bind(code, &model);
+
+    NamespaceModelItem ns = dom->findNamespace("N");
+    QVERIFY(ns);
+    ClassModelItem a = ns->findClass("A");
+    QVERIFY(a);
+    QCOMPARE(a->qualifiedName(), QStringList() << "N" << "A");
+
+    // equal qualified names are one handle, and equal names one string
+    FunctionList overloads = a->findFunctions("f");
+    QCOMPARE(overloads.size(), 2);
+    QCOMPARE(overloads.at(0)->internedQualifiedName(), overloads.at(1)->internedQualifiedName());
+    QCOMPARE(overloads.at(0)->internedScope(), a->internedQualifiedName());
+    QCOMPARE(a->findVariable("g")->internedScope(), a->internedQualifiedName());
+    QCOMPARE(a->internedScope(), ns->internedQualifiedName());
+    QCOMPARE(model.qualifiedName(QStringList() << "N" << "A" << "f"), overloads.at(0)->internedQualifiedName());
+    QCOMPARE(model.qualifiedName(QStringList()), model.globalScope());
+
+    FunctionModelItem nf = ns->findFunctions("f").first();
+    QVERIFY(nf->internedQualifiedName() != overloads.at(0)->internedQualifiedName());
+    QCOMPARE(nf->name().constData(), overloads.at(0)->name().constData());
+    QCOMPARE(nf->fileName().constData(), a->fileName().constData());
+
+    // an item without a name goes by the name of its scope
+    overloads.at(0)->setName(QString());
+    QCOMPARE(overloads.at(0)->internedQualifiedName(), a->internedQualifiedName());
+    QCOMPARE(overloads.at(0)->qualifiedName(), a->qualifiedName());
+}
+
+void TestBinder::testItemPool()
+{
+    CodeModel model;
+    // the global namespace
+    QCOMPARE(model.itemCount(), 1);
+
+    FileModelItem dom = bind("namespace N { struct A { int f(int a); }; }\n", &model);
+
+    // the file, the namespace, the class, the function and its argument
+    QVERIFY(model.itemCount() >= 6);
+    QVERIFY(model.itemMemory() >= model.itemCount() * sizeof(_CodeModelItem));
+
+    // handles are plain pointers to the items the model keeps
+    ClassModelItem a = dom->findNamespace("N")->findClass("A");
+    QVERIFY(a);
+    QCOMPARE(a->model(), &model);
+    QCOMPARE(dom->findNamespace("N")->findClass("A").data(), a.data());
+    QCOMPARE(a->findFunctions("f").first()->arguments().first()->name(), QString("a"));
+}
+
+QTEST_APPLESS_MAIN(TestBinder)
+
+#include "testbinder.moc"
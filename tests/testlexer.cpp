@@ -0,0 +1,205 @@
+/*
+* This file is part of the API Extractor project.
+*
+* Copyright (C) 2009 Nokia Corporation and/or its subsidiary(-ies).
+*
+* Contact: PySide team <contact@pyside.org>
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* version 2 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+* 02110-1301 USA
+*
+*/
+
+
+#include "testlexer.h"
+#include <QtTest/QTest>
+#include <QFile>
+#include <QLibraryInfo>
+#include <QTime>
+#include <QStringList>
+#include "parser/lexer.h"
+#include "parser/control.h"
+#include "parser/tokens.h"
+#include "parser/rpp/pp.h"
+
+// the kinds of the tokens in text, up to the end of file
+static QList<int> tokenKinds(const std::string& text)
+{
+    Control control;
+    TokenStream tokens;
+    LocationTable locationTable;
+    LocationTable lineTable;
+    LocationManager location(tokens, locationTable, lineTable);
+    Lexer lexer(location, &control);
+    lexer.tokenize(text.c_str(), text.size());
+
+    QList<int> kinds;
+    for (std::size_t i = 1; tokens.kind(i) != Token_EOF; ++i)
+        kinds << tokens.kind(i);
+    return kinds;
+}
+
+void TestLexer::testKeywords()
+{
+    QCOMPARE(tokenKinds("class"), QList<int>() << Token_class);
+    QCOMPARE(tokenKinds("reinterpret_cast"), QList<int>() << Token_reinterpret_cast);
+    QCOMPARE(tokenKinds("Q_INVOKABLE"), QList<int>() << Token_Q_INVOKABLE);
+    // same length, first and last characters
+    QCOMPARE(tokenKinds("delete double"), QList<int>() << Token_delete << Token_double);
+    QCOMPARE(tokenKinds("template typename"), QList<int>() << Token_template << Token_typename);
+    // left to the parser
+    QCOMPARE(tokenKinds("true false wchar_t"), QList<int>() << Token_identifier << Token_identifier << Token_identifier);
+
+    // every token name either is its keyword or an identifier, and so
+    // are the names with a character more, less or changed
+    for (int kind = Token_K_DCOP; kind < TOKEN_KIND_COUNT; ++kind) {
+        std::string name = token_name(kind);
+        std::string similar[] = { name + "_", name.substr(0, name.size() - 1), name.substr(0, name.size() - 1) + "Z", "_" + name };
+        std::string text = name;
+        for (int i = 0; i < 4; ++i)
+            text += " " + similar[i];
+
+        QList<int> kinds = tokenKinds(text);
+        QVERIFY(kinds.first() == kind || kinds.first() == Token_identifier);
+        for (int i = 1; i < kinds.size(); ++i)
+            QVERIFY(kinds.at(i) == Token_identifier || token_name(kinds.at(i)) == similar[i - 1]);
+    }
+}
+
+void TestLexer::testTokenSizes()
+{
+    // sizes are not stored, the token stream scans the tokens again
+    std::string text("a->*b x.y z <<= 1.5e3 L\"s\\\"\" 'c' and_eq ...");
+    QStringList expected;
+    expected << "a" << "->" << "*" << "b" << "x" << "." << "y" << "z" << "<<=" << "1.5e3"
+             << "L\"s\\\"\"" << "'c'" << "and_eq" << "...";
+
+    Control control;
+    TokenStream tokens;
+    LocationTable locationTable;
+    LocationTable lineTable;
+    LocationManager location(tokens, locationTable, lineTable);
+    Lexer lexer(location, &control);
+    lexer.tokenize(text.c_str(), text.size());
+
+    QStringList found;
+    for (std::size_t i = 1; tokens.kind(i) != Token_EOF; ++i) {
+        Token tk = tokens.token((int) i);
+        found << QString::fromLatin1(tk.text + tk.position, (int) tk.size);
+    }
+    QCOMPARE(found, expected);
+}
+
+void TestLexer::testLineMarkers()
+{
+    std::string text("# 1 \"a.h\"\nint a;\n# 10 \"b.h\"\n\nint  b;\n# 3 \"a.h\"\nint c;\n");
+
+    Control control;
+    TokenStream tokens;
+    LocationTable locationTable;
+    LocationTable lineTable;
+    LocationManager location(tokens, locationTable, lineTable);
+    Lexer lexer(location, &control);
+    lexer.tokenize(text.c_str(), text.size());
+
+    // the identifiers a, b and c
+    int expectedLines[] = { 1, 11, 3 };
+    const char* expectedFiles[] = { "a.h", "b.h", "a.h" };
+    for (int i = 0; i < 3; ++i) {
+        int line, column;
+        QString fileName;
+        location.positionAt(tokens.position(2 + 3 * i), &line, &column, &fileName);
+        QCOMPARE(line, expectedLines[i]);
+        QCOMPARE(column, i == 1 ? 5 : 4);
+        QCOMPARE(fileName, QString(expectedFiles[i]));
+    }
+}
+
+void TestLexer::testNameInterning()
+{
+    std::string text("foo bar foo foobar bar");
+
+    Control control;
+    TokenStream tokens;
+    LocationTable locationTable;
+    LocationTable lineTable;
+    LocationManager location(tokens, locationTable, lineTable);
+    Lexer lexer(location, &control);
+    lexer.tokenize(text.c_str(), text.size());
+
+    QCOMPARE(tokens.symbol(1), tokens.symbol(3));
+    QCOMPARE(tokens.symbol(2), tokens.symbol(5));
+    QVERIFY(tokens.symbol(1) != tokens.symbol(2));
+    QVERIFY(tokens.symbol(1) != tokens.symbol(4));
+    QCOMPARE(tokens.symbol(4)->as_string(), QString("foobar"));
+
+    // enough names to grow the table a few times
+    NameTable names;
+    QList<const NameSymbol*> symbols;
+    QList<QByteArray> texts;
+    for (int i = 0; i < 20000; ++i) {
+        texts << QByteArray("name") + QByteArray::number(i);
+        symbols << names.findOrInsert(texts.last().constData(), texts.last().size());
+    }
+    QCOMPARE(names.count(), std::size_t(20000));
+    for (int i = 0; i < 20000; i += 7) {
+        QByteArray text = QByteArray("name") + QByteArray::number(i);
+        QCOMPARE(names.findOrInsert(text.constData(), text.size()), symbols.at(i));
+    }
+
+    // a control given a table interns its names there
+    Control control(&names);
+    QCOMPARE(control.findOrInsertName("name42", 6), symbols.at(42));
+}
+
+void TestLexer::benchmarkLexer()
+{
+    // a large translation unit: the Qt GUI module, headers as found
+    QString headers = QLibraryInfo::location(QLibraryInfo::HeadersPath);
+    if (!QFile::exists(headers + "/QtGui/QtGui"))
+        QSKIP("The Qt headers are not installed", SkipAll);
+
+    rpp::pp_environment env;
+    rpp::pp preprocess(env);
+    preprocess.push_include_path(headers.toStdString());
+    preprocess.push_include_path((headers + "/QtCore").toStdString());
+    preprocess.push_include_path((headers + "/QtGui").toStdString());
+    std::string text;
+    preprocess.file((headers + "/QtGui/QtGui").toStdString(), rpp::pp_output_iterator<std::string>(text));
+    QVERIFY(text.size() > 1024 * 1024);
+
+    int best = 0;
+    for (int round = 0; round < 5; ++round) {
+        Control control;
+        TokenStream tokens;
+        LocationTable locationTable;
+        LocationTable lineTable;
+        LocationManager location(tokens, locationTable, lineTable);
+        Lexer lexer(location, &control);
+
+        QTime timer;
+        timer.start();
+        lexer.tokenize(text.c_str(), text.size());
+        int elapsed = timer.elapsed();
+        if (!round || elapsed < best)
+            best = elapsed;
+    }
+
+    double megabytes = text.size() / (1024.0 * 1024.0);
+    qDebug("Lexed %.1f MB in %d ms: %.1f MB/s", megabytes, best, best ? megabytes * 1000 / best : 0.0);
+}
+
+QTEST_APPLESS_MAIN(TestLexer)
+
+#include "testlexer.moc"
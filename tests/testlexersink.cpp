@@ -0,0 +1,66 @@
+/*
+* This file is part of the API Extractor project.
+*
+* Copyright (C) 2009 Nokia Corporation and/or its subsidiary(-ies).
+*
+* Contact: PySide team <contact@pyside.org>
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* version 2 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+* 02110-1301 USA
+*
+*/
+
+
+#include "testlexersink.h"
+#include <QtTest/QTest>
+#include <QBuffer>
+#include "abstractmetabuilder.h"
+#include "typedatabase.h"
+#include "reporthandler.h"
+
+void TestLexerSink::testBuildFromSink()
+{
+    // large enough for the sink to feed the lexer several times
+    QByteArray cppCode;
+    QByteArray xmlCode("<typesystem package='Foo'><primitive-type name='int'/>");
+    for (int i = 0; i < 1000; ++i) {
+        cppCode += QString("struct A%1 {\n    int value() const { return %1; }\n    void setValue(int value);\n};\n").arg(i).toLatin1();
+        xmlCode += QString("<value-type name='A%1'/>").arg(i).toLatin1();
+    }
+    xmlCode += "</typesystem>";
+
+    ReportHandler::setSilent(true);
+    QBuffer buffer;
+    buffer.setData(xmlCode);
+    TypeDatabase::instance(true)->parseFile(&buffer);
+
+    AbstractMetaBuilder builder;
+    std::string text;
+    LexerSink sink = builder.lexerSink(text);
+    for (int i = 0; i < cppCode.size(); ++i)
+        *sink++ = cppCode.at(i);
+    QVERIFY(text == std::string(cppCode.constData(), cppCode.size()));
+    QVERIFY(builder.build(text.c_str(), text.size()));
+
+    AbstractMetaClassList classes = builder.classes();
+    QCOMPARE(classes.count(), 1000);
+    AbstractMetaClass* last = classes.findClass("A999");
+    QVERIFY(last);
+    QVERIFY(last->findFunction("value"));
+    QVERIFY(last->findFunction("setValue"));
+}
+
+QTEST_APPLESS_MAIN(TestLexerSink)
+
+#include "testlexersink.moc"
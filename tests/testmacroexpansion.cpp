@@ -0,0 +1,178 @@
+/*
+* This file is part of the API Extractor project.
+*
+* Copyright (C) 2011 Nokia Corporation and/or its subsidiary(-ies).
+*
+* Contact: PySide team <contact@pyside.org>
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* version 2 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+* 02110-1301 USA
+*
+*/
+
+#include "testmacroexpansion.h"
+#include <QtTest/QTest>
+#include <cstdlib>
+#include <new>
+#include "parser/rpp/pp.h"
+
+// counts the heap allocations made by this test, through every form of
+// operator new that can be replaced
+static int allocationCount = 0;
+
+#if __cplusplus >= 201103L
+#define NOTHROW noexcept
+#else
+#define NOTHROW throw()
+#endif
+
+static void* countedAllocation(std::size_t size) NOTHROW
+{
+    ++allocationCount;
+    return std::malloc(size ? size : 1);
+}
+
+void* operator new(std::size_t size)
+{
+    void* ptr = countedAllocation(size);
+    if (!ptr)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new[](std::size_t size)
+{
+    void* ptr = countedAllocation(size);
+    if (!ptr)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) NOTHROW
+{
+    return countedAllocation(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) NOTHROW
+{
+    return countedAllocation(size);
+}
+
+void operator delete(void* ptr) NOTHROW
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) NOTHROW
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) NOTHROW
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) NOTHROW
+{
+    std::free(ptr);
+}
+
+#ifdef __cpp_sized_deallocation
+void operator delete(void* ptr, std::size_t) NOTHROW
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) NOTHROW
+{
+    std::free(ptr);
+}
+#endif
+
+static const char macroDefinitions[] = "\
+#define Q_PROPERTY(text)\n\
+#define Q_FLAGS(x)\n\
+#define Q_DECLARE_FLAGS(Flags, Enum) typedef QFlags<Enum> Flags;\n\
+#define Q_DECLARE_METATYPE(TYPE) template <> struct QMetaTypeId< TYPE > { static int id() { return qRegisterMetaType< TYPE >(#TYPE); } };\n\
+#define QT_MAX(a, b) ((a) > (b) ? (a) : (b))\n";
+
+static const char macroUses[] = "\
+class Object { Q_PROPERTY(int value READ value WRITE setValue) Q_FLAGS(Flags) Q_DECLARE_FLAGS(Flags, Flag) int x = QT_MAX(QT_MAX(1, 2), 3); };\n\
+Q_DECLARE_METATYPE(Object)\n";
+
+static std::string repeat(const char* text, int count)
+{
+    std::string result;
+    for (int i = 0; i < count; ++i)
+        result += text;
+    return result;
+}
+
+static void preprocess(rpp::pp& preprocess, const std::string& text, std::string* result)
+{
+    preprocess(text.c_str(), text.c_str() + text.size(), rpp::pp_output_iterator<std::string>(*result));
+}
+
+void TestMacroExpansion::testActuals()
+{
+    rpp::pp_environment env;
+    rpp::pp preprocess(env);
+    std::string result;
+    ::preprocess(preprocess, std::string(macroDefinitions) + macroUses, &result);
+
+    QVERIFY(result.find("typedef QFlags<Flag> Flags;") != std::string::npos);
+    QVERIFY(result.find("((((1) > (2) ? (1) : (2))) > (3) ? (((1) > (2) ? (1) : (2))) : (3))") != std::string::npos);
+    QVERIFY(result.find("qRegisterMetaType< Object >(\"Object\")") != std::string::npos);
+}
+
+void TestMacroExpansion::testActualsDontAllocate()
+{
+    rpp::pp_environment env;
+    rpp::pp preprocess(env);
+    std::string result;
+    ::preprocess(preprocess, macroDefinitions, &result);
+
+    // warm up the buffers the actuals are collected in
+    ::preprocess(preprocess, macroUses, &result);
+
+    std::string uses = repeat(macroUses, 1000);
+    result.clear();
+    result.reserve(uses.size() * 4);
+
+    int before = allocationCount;
+    ::preprocess(preprocess, uses, &result);
+    int allocations = allocationCount - before;
+
+    // 7000 macro invocations, none of them should allocate
+    QVERIFY2(allocations < 100, qPrintable(QString("%1 allocations").arg(allocations)));
+}
+
+void TestMacroExpansion::benchmarkMacroExpansion()
+{
+    rpp::pp_environment env;
+    rpp::pp preprocess(env);
+    std::string result;
+    ::preprocess(preprocess, macroDefinitions, &result);
+
+    std::string uses = repeat(macroUses, 1000);
+    QBENCHMARK {
+        result.clear();
+        ::preprocess(preprocess, uses, &result);
+    }
+}
+
+QTEST_APPLESS_MAIN(TestMacroExpansion)
+
+#include "testmacroexpansion.moc"
@@ -0,0 +1,137 @@
+/*
+* This file is part of the API Extractor project.
+*
+* Copyright (C) 2011 Nokia Corporation and/or its subsidiary(-ies).
+*
+* Contact: PySide team <contact@pyside.org>
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* version 2 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+* 02110-1301 USA
+*
+*/
+
+#include "testparallelpreprocessor.h"
+#include <QtTest/QTest>
+#include <QFile>
+#include <QCoreApplication>
+#include <sstream>
+#include "parallelpreprocessor.h"
+#include "parser/rpp/pp.h"
+
+// the code lines of the output, without line markers and blank lines
+static std::string codeOf(const std::string& text)
+{
+    std::istringstream in(text);
+    std::string line;
+    std::string code;
+    while (std::getline(in, line)) {
+        std::size_t begin = line.find_first_not_of(" \t");
+        if (begin != std::string::npos && line[begin] != '#')
+            code += line.substr(begin) + '\n';
+    }
+    return code;
+}
+
+void TestParallelPreprocessor::initTestCase()
+{
+    QString path = QDir::tempPath() + QString("/testparallelpreprocessor-%1").arg(QCoreApplication::applicationPid());
+    QDir().mkpath(path);
+    m_dir = QDir(path);
+}
+
+void TestParallelPreprocessor::cleanupTestCase()
+{
+    foreach (QString entry, m_dir.entryList(QDir::Files))
+        m_dir.remove(entry);
+    QDir().rmdir(m_dir.absolutePath());
+}
+
+QString TestParallelPreprocessor::writeFile(const QString& fileName, const char* contents)
+{
+    QFile file(m_dir.absoluteFilePath(fileName));
+    file.open(QIODevice::WriteOnly);
+    file.write(contents);
+    file.close();
+    return file.fileName();
+}
+
+void TestParallelPreprocessor::testMergeMatchesSerialRun()
+{
+    writeFile("shared.h", "\
+    #ifndef SHARED_H\n\
+    #define SHARED_H\n\
+    #define SHARED_VALUE 1\n\
+    int shared;\n\
+    #endif\n");
+    writeFile("guarded.h", "\
+    #ifndef GUARDED_H\n\
+    #define GUARDED_H\n\
+    int guarded;\n\
+    #endif\n");
+    writeFile("first.h", "#include \"shared.h\"\nint first = SHARED_VALUE;\n");
+
+    // independent of each other, they only read the guard of the first
+    writeFile("defines.h", "#include \"shared.h\"\n#define DEFINED_VALUE 2\nint defines;\n");
+    writeFile("other.h", "#include \"guarded.h\"\nint other;\n");
+
+    // these read a macro and a guard defined by the two above
+    writeFile("uses.h", "int uses = DEFINED_VALUE;\n");
+    writeFile("again.h", "#include \"guarded.h\"\nint again;\n");
+
+    QString globalFile = writeFile("global.h", "\
+    #include \"first.h\"\n\
+    #include \"defines.h\"\n\
+    #include \"other.h\"\n\
+    #include \"uses.h\"\n\
+    #include \"again.h\"\n");
+
+    rpp::pp_environment serialEnv;
+    rpp::pp serial(serialEnv);
+    std::string expected;
+    serial.file(globalFile.toStdString(), rpp::pp_output_iterator<std::string>(expected));
+    QVERIFY(expected.find("int uses = 2;") != std::string::npos);
+
+    rpp::pp_environment env;
+    rpp::pp preprocess(env);
+    std::string result;
+    QVERIFY(preprocessInParallel(preprocess, env, globalFile, result));
+    QCOMPARE(codeOf(result), codeOf(expected));
+
+    // the macros of every include end up in the environment
+    QVERIFY(env.resolve("SHARED_VALUE", 12));
+    QVERIFY(env.resolve("DEFINED_VALUE", 13));
+    QVERIFY(env.resolve("GUARDED_H", 9));
+}
+
+void TestParallelPreprocessor::testNotOnlyIncludes()
+{
+    writeFile("a.h", "int a;\n");
+    writeFile("b.h", "int b;\n");
+    writeFile("c.h", "int c;\n");
+    QString globalFile = writeFile("global_code.h", "\
+    #include \"a.h\"\n\
+    #include \"b.h\"\n\
+    int code;\n\
+    #include \"c.h\"\n");
+
+    rpp::pp_environment env;
+    rpp::pp preprocess(env);
+    std::string result;
+    QVERIFY(!preprocessInParallel(preprocess, env, globalFile, result));
+    QVERIFY(result.empty());
+}
+
+QTEST_APPLESS_MAIN(TestParallelPreprocessor)
+
+#include "testparallelpreprocessor.moc"
@@ -0,0 +1,234 @@
+/*
+* This file is part of the API Extractor project.
+*
+* Copyright (C) 2009 Nokia Corporation and/or its subsidiary(-ies).
+*
+* Contact: PySide team <contact@pyside.org>
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* version 2 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+* 02110-1301 USA
+*
+*/
+
+
+#include "testparser.h"
+#include <QtTest/QTest>
+#include <QStringList>
+#include "parser/parser.h"
+#include "parser/control.h"
+#include "parser/default_visitor.h"
+
+// the kind and tokens of every node of the tree
+class TreeDumper : public DefaultVisitor
+{
+public:
+    void visit(AST *node)
+    {
+        if (!node)
+            return;
+
+        nodes << QString("%1 %2-%3").arg(node->kind).arg(node->start_token).arg(node->end_token);
+        DefaultVisitor::visit(node);
+    }
+
+    QStringList nodes;
+};
+
+static QStringList parseTree(const QByteArray& code, bool memoizing, Parser::RuleStatistics *templateNames = 0,
+                             std::size_t *rewinds = 0, int *errors = 0, bool parallel = false)
+{
+    Control control;
+    Parser parser(&control);
+    parser.setMemoizing(memoizing);
+    parser.setParallel(parallel);
+    pool p;
+    TranslationUnitAST *ast = parser.parse(code.constData(), code.size(), &p);
+
+    if (templateNames)
+        *templateNames = parser.ruleStatistics(Parser::MemoTemplateName);
+    if (rewinds)
+        *rewinds = parser.rewinds();
+    if (errors)
+        *errors = control.errorMessages().size();
+
+    TreeDumper dumper;
+    dumper.visit(ast);
+    return dumper.nodes;
+}
+
+void TestParser::testMemoizedRetries()
+{
+    const char* code = "\
+    template <typename T, int N> struct A { T values[N]; };\n\
+    std::map<int, A<std::vector<int>, 3> > m;\n\
+    void f(A<B<int>, 2> a, int (*g)(const A<int, 1>&), const char* = 0);\n\
+    int main() { A<int, 1> a; f(a, 0); return sizeof(A<char, 2>) + x < y; }\n";
+
+    Parser::RuleStatistics memoized;
+    Parser::RuleStatistics reparsed;
+    std::size_t memoizedRewinds;
+    std::size_t reparsedRewinds;
+    QStringList tree = parseTree(code, true, &memoized, &memoizedRewinds);
+    QCOMPARE(parseTree(code, false, &reparsed, &reparsedRewinds), tree);
+    QVERIFY(tree.size() > 50);
+
+    QVERIFY(memoized.hits > 0);
+    QCOMPARE(reparsed.hits, std::size_t(0));
+    QVERIFY(memoized.calls < reparsed.calls);
+    QVERIFY(memoizedRewinds < reparsedRewinds);
+}
+
+void TestParser::testErrorsAfterRetries()
+{
+    // the errors are found by attempts that are retried, and are reported again
+    const char* code = "\
+    void f(A<int, > a);\n\
+    struct B { void g(C<D<int>, 1 +> c) };\n\
+    int h(E<F<int>> e);\n";
+
+    int memoizedErrors;
+    int reparsedErrors;
+    QStringList tree = parseTree(code, true, 0, 0, &memoizedErrors);
+    QCOMPARE(parseTree(code, false, 0, 0, &reparsedErrors), tree);
+    QVERIFY(memoizedErrors > 0);
+    QCOMPARE(memoizedErrors, reparsedErrors);
+}
+
+void TestParser::testPoolReset()
+{
+    pool p(1024);
+    QCOMPARE(p.used(), std::size_t(0));
+
+    void *first = p.allocate(100, 8);
+    pool::mark_type mark = p.mark();
+    void *second = p.allocate(100, 8);
+    // more than the blocks left, and than a block
+    for (int i = 0; i < 100; ++i)
+        p.allocate(64, 8);
+    p.allocate(10000, 8);
+    std::size_t reserved = p.reserved();
+    QVERIFY(reserved >= 100 * 64 + 10000);
+
+    p.reset(mark);
+    QCOMPARE(p.used(), std::size_t(100));
+    QCOMPARE(p.allocate(100, 8), second);
+
+    // the blocks are reused, not allocated again
+    for (int i = 0; i < 100; ++i)
+        QVERIFY(reinterpret_cast<std::size_t>(p.allocate(64, 8)) % 8 == 0);
+    p.allocate(10000, 8);
+    QCOMPARE(p.reserved(), reserved);
+
+    p.clear();
+    QCOMPARE(p.used(), std::size_t(0));
+    QCOMPARE(p.allocate(100, 8), first);
+}
+
+void TestParser::testNodeStatistics()
+{
+    const char* code = "\
+    namespace N { struct A { int (A::*m)(); void f(int a, int *b = 0); }; }\n";
+
+    Control control;
+    Parser parser(&control);
+    pool p;
+    parser.parse(code, qstrlen(code), &p);
+
+    QCOMPARE(p.node_count(AST::Kind_Namespace), std::size_t(1));
+    QCOMPARE(p.node_bytes(AST::Kind_Namespace), sizeof(NamespaceAST));
+    QCOMPARE(p.node_count(AST::Kind_ParameterDeclaration), std::size_t(2));
+
+    // the nodes of failed attempts are given back
+    std::size_t allocated = 0;
+    for (int kind = 0; kind < AST::NODE_KIND_COUNT; ++kind)
+        allocated += p.node_bytes(kind);
+    QVERIFY(p.used() < allocated);
+    QVERIFY(p.used() <= p.reserved());
+}
+
+void TestParser::testParallelParsing()
+{
+    // enough declarations for a few chunks, with namespaces and errors
+    QByteArray code;
+    for (int i = 0; i < 3000; ++i) {
+        QByteArray n = QByteArray::number(i);
+        if (i % 100 == 0)
+            code += "namespace N" + n + " { struct S { int m(int); }; typedef S T; }\n";
+        else if (i % 250 == 1)
+            code += "void g" + n + "(A<int, > a); struct E" + n + " { int (; };\n";
+        else
+            code += "int f" + n + "(A<int, " + n + "> a, const char *b = \"x;\");\n";
+    }
+
+    int serialErrors;
+    int parallelErrors;
+    QStringList tree = parseTree(code, true, 0, 0, &serialErrors);
+    QCOMPARE(parseTree(code, true, 0, 0, &parallelErrors, true), tree);
+    QVERIFY(serialErrors > 0);
+    QCOMPARE(parallelErrors, serialErrors);
+}
+
+// the trees of the declarations handed over, and the most nodes held
+class DeclarationDumper : public DeclarationConsumer
+{
+public:
+    DeclarationDumper(pool *p) : memory(p), used(0) {}
+
+    void declaration(DeclarationAST *node)
+    {
+        dumper.visit(node);
+        used = qMax(used, memory->used());
+    }
+
+    TreeDumper dumper;
+    pool *memory;
+    std::size_t used;
+};
+
+void TestParser::testDeclarationConsumer()
+{
+    QByteArray code;
+    for (int i = 0; i < 500; ++i) {
+        QByteArray n = QByteArray::number(i);
+        code += "namespace N" + n + " { template <class T> struct S : A<T, " + n + "> { int m(B<T> b, int (*f)(S<T>)); }; }\n";
+        if (i % 100 == 1)
+            code += "void g" + n + "(A<int, > a);\n";
+    }
+
+    QStringList tree = parseTree(code, true);
+    // without the translation unit
+    tree.removeFirst();
+
+    Control control;
+    Parser parser(&control);
+    pool p;
+    DeclarationDumper consumer(&p);
+    parser.setDeclarationConsumer(&consumer);
+    TranslationUnitAST *ast = parser.parse(code.constData(), code.size(), &p);
+
+    QVERIFY(!ast->declarations);
+    QCOMPARE(consumer.dumper.nodes, tree);
+    QVERIFY(control.errorMessages().size() > 0);
+
+    // the pool holds a declaration at a time, not the whole tree
+    Control serialControl;
+    Parser serial(&serialControl);
+    pool q;
+    serial.parse(code.constData(), code.size(), &q);
+    QVERIFY(consumer.used * 100 < q.used());
+}
+
+QTEST_APPLESS_MAIN(TestParser)
+
+#include "testparser.moc"
@@ -0,0 +1,614 @@
+/*
+* This file is part of the API Extractor project.
+*
+* Copyright (C) 2011 Nokia Corporation and/or its subsidiary(-ies).
+*
+* Contact: PySide team <contact@pyside.org>
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* version 2 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+* 02110-1301 USA
+*
+*/
+
+#include "testpreprocessor.h"
+#include <QtTest/QTest>
+#include <QFile>
+#include <QCoreApplication>
+#include <QLibraryInfo>
+#include <QStringList>
+#include <sstream>
+#include "parser/rpp/pp.h"
+
+static int countOf(const std::string& text, const std::string& what)
+{
+    int count = 0;
+    for (std::size_t pos = text.find(what); pos != std::string::npos; pos = text.find(what, pos + 1))
+        ++count;
+    return count;
+}
+
+static std::string preprocessFile(rpp::pp_environment& env, const QString& fileName, rpp::pp_cache* cache = 0)
+{
+    rpp::pp preprocess(env);
+    preprocess.set_cache(cache);
+
+    std::string result;
+    preprocess.file(fileName.toStdString(), rpp::pp_output_iterator<std::string>(result));
+    return result;
+}
+
+void TestPreprocessor::initTestCase()
+{
+    QString path = QDir::tempPath() + QString("/testpreprocessor-%1").arg(QCoreApplication::applicationPid());
+    QDir().mkpath(path + "/cache");
+    QDir().mkpath(path + "/first");
+    QDir().mkpath(path + "/second");
+    m_dir = QDir(path);
+
+    writeFile("a.h", "\
+    #ifndef A_H\n\
+    #define A_H\n\
+    #include \"b.h\"\n\
+    #define A_VALUE (B_VALUE + 1)\n\
+    int a = A_VALUE;\n\
+    #endif\n");
+    writeFile("b.h", "\
+    #ifdef USE_LONG\n\
+    typedef long b_type;\n\
+    #else\n\
+    typedef int b_type;\n\
+    #endif\n\
+    #define B_VALUE 41\n");
+    writeFile("main.h", "\
+    #include \"a.h\"\n\
+    #include \"a.h\"\n\
+    b_type x = A_VALUE;\n");
+}
+
+void TestPreprocessor::cleanupTestCase()
+{
+    foreach (QString subdir, QStringList() << "cache" << "first" << "second") {
+        QDir dir(m_dir.absoluteFilePath(subdir));
+        foreach (QString entry, dir.entryList(QDir::Files))
+            dir.remove(entry);
+        m_dir.rmdir(subdir);
+    }
+    foreach (QString entry, m_dir.entryList(QDir::Files))
+        m_dir.remove(entry);
+    QDir().rmdir(m_dir.absolutePath());
+}
+
+QString TestPreprocessor::writeFile(const QString& fileName, const char* contents)
+{
+    QFile file(m_dir.absoluteFilePath(fileName));
+    file.open(QIODevice::WriteOnly);
+    file.write(contents);
+    file.close();
+    return file.fileName();
+}
+
+void TestPreprocessor::testCacheReplay()
+{
+    QString mainFile = m_dir.absoluteFilePath("main.h");
+
+    rpp::pp_environment plainEnv;
+    std::string expected = preprocessFile(plainEnv, mainFile);
+    QVERIFY(expected.find("int a = (41 + 1);") != std::string::npos);
+    QVERIFY(expected.find("b_type x = (41 + 1);") != std::string::npos);
+
+    rpp::pp_cache cache(m_dir.absoluteFilePath("cache").toStdString());
+
+    rpp::pp_environment coldEnv;
+    QCOMPARE(preprocessFile(coldEnv, mainFile, &cache), expected);
+    QVERIFY(cache.misses() > 0);
+
+    int misses = cache.misses();
+    rpp::pp_environment warmEnv;
+    QCOMPARE(preprocessFile(warmEnv, mainFile, &cache), expected);
+    QCOMPARE(cache.misses(), misses);
+    QVERIFY(cache.hits() > 0);
+
+    // the macros defined by the cached headers must be replayed as well
+    QVERIFY(warmEnv.resolve("A_H", 3));
+    QVERIFY(warmEnv.resolve("B_VALUE", 7));
+    QVERIFY(warmEnv.resolve("A_VALUE", 7));
+}
+
+void TestPreprocessor::testCacheInvalidatedByMacro()
+{
+    QString mainFile = m_dir.absoluteFilePath("main.h");
+    rpp::pp_cache cache(m_dir.absoluteFilePath("cache").toStdString());
+
+    rpp::pp_environment env;
+    preprocessFile(env, mainFile, &cache);
+
+    // b.h tests USE_LONG, so its cached output must not be reused
+    rpp::pp_environment longEnv;
+    rpp::pp_macro macro;
+    macro.definition = longEnv.symbols().get(std::string("1"));
+    longEnv.bind(longEnv.symbols().get(std::string("USE_LONG")), macro);
+
+    std::string result = preprocessFile(longEnv, mainFile, &cache);
+    QVERIFY(result.find("typedef long b_type;") != std::string::npos);
+    QVERIFY(result.find("typedef int b_type;") == std::string::npos);
+}
+
+static std::string preprocessWithPaths(const QString& fileName, const QStringList& includePaths, rpp::pp_cache* cache)
+{
+    rpp::pp_environment env;
+    rpp::pp preprocess(env);
+    preprocess.set_cache(cache);
+    foreach (QString path, includePaths)
+        preprocess.push_include_path(path.toStdString());
+
+    std::string result;
+    preprocess.file(fileName.toStdString(), rpp::pp_output_iterator<std::string>(result));
+    return result;
+}
+
+void TestPreprocessor::testCacheInvalidatedByInclude()
+{
+    writeFile("second/found.h", "int from_second;\n");
+    QString mainFile = writeFile("main_resolution.h", "\
+    #include <found.h>\n\
+    #include \"created.h\"\n\
+    int main_body;\n");
+    QStringList includePaths;
+    includePaths << m_dir.absoluteFilePath("first") + "/" << m_dir.absoluteFilePath("second") + "/";
+    rpp::pp_cache cache(m_dir.absoluteFilePath("cache").toStdString());
+
+    std::string result = preprocessWithPaths(mainFile, includePaths, &cache);
+    QVERIFY(result.find("int from_second;") != std::string::npos);
+    QCOMPARE(preprocessWithPaths(mainFile, includePaths, &cache), result);
+    QVERIFY(cache.hits() > 0);
+
+    // a header earlier on the include path now wins
+    writeFile("first/found.h", "int from_first;\n");
+    result = preprocessWithPaths(mainFile, includePaths, &cache);
+    QVERIFY(result.find("int from_first;") != std::string::npos);
+    QVERIFY(result.find("int from_second;") == std::string::npos);
+
+    // and a header that was missing is now found
+    writeFile("created.h", "int created;\n");
+    result = preprocessWithPaths(mainFile, includePaths, &cache);
+    QVERIFY(result.find("int created;") != std::string::npos);
+    QCOMPARE(result, preprocessWithPaths(mainFile, includePaths, 0));
+}
+
+void TestPreprocessor::testCacheStoresOwnOutput()
+{
+    writeFile("innermost.h", "const char* innermost = \"innermost text\";\n");
+    writeFile("middle.h", "#include \"innermost.h\"\nint middle;\n");
+    writeFile("outer.h", "#include \"middle.h\"\nint outer;\n");
+    QString mainFile = writeFile("main_chain.h", "#include \"outer.h\"\nint top;\n");
+
+    rpp::pp_cache cache(m_dir.absoluteFilePath("cache").toStdString());
+    std::string expected = preprocessWithPaths(mainFile, QStringList(), 0);
+    QCOMPARE(preprocessWithPaths(mainFile, QStringList(), &cache), expected);
+
+    // the text of the innermost header is only kept in its own entry
+    QDir cacheDir(m_dir.absoluteFilePath("cache"));
+    int copies = 0;
+    foreach (QString entry, cacheDir.entryList(QDir::Files)) {
+        QFile file(cacheDir.absoluteFilePath(entry));
+        file.open(QIODevice::ReadOnly);
+        copies += file.readAll().count("innermost text");
+    }
+    QCOMPARE(copies, 1);
+
+    int misses = cache.misses();
+    QCOMPARE(preprocessWithPaths(mainFile, QStringList(), &cache), expected);
+    QCOMPARE(cache.misses(), misses);
+}
+
+void TestPreprocessor::testPragmaOnce()
+{
+    writeFile("once.h", "\
+    #pragma once\n\
+    int once;\n");
+    QString mainFile = writeFile("main_once.h", "\
+    #include \"once.h\"\n\
+    #include \"once.h\"\n");
+
+    rpp::pp_environment env;
+    QCOMPARE(countOf(preprocessFile(env, mainFile), "int once;"), 1);
+}
+
+void TestPreprocessor::testPartialIncludeGuard()
+{
+    // the declaration after #endif is not protected by the guard
+    writeFile("partial.h", "\
+    #ifndef PARTIAL_H\n\
+    #define PARTIAL_H\n\
+    int guarded;\n\
+    #endif\n\
+    int unguarded;\n");
+    QString mainFile = writeFile("main_partial.h", "\
+    #include \"partial.h\"\n\
+    #include \"partial.h\"\n\
+    #include \"partial.h\"\n");
+
+    rpp::pp_environment env;
+    std::string result = preprocessFile(env, mainFile);
+    QCOMPARE(countOf(result, "int guarded;"), 1);
+    QCOMPARE(countOf(result, "int unguarded;"), 3);
+}
+
+void TestPreprocessor::testIncludeSpellings()
+{
+    // a header reached through another path is the same file
+    writeFile("spelled_once.h", "\
+    #pragma once\n\
+    int spelled_once;\n");
+    writeFile("spelled_guarded.h", "\
+    #ifndef SPELLED_GUARDED_H\n\
+    #define SPELLED_GUARDED_H\n\
+    int spelled_guarded;\n\
+    #endif\n");
+    QString mainFile = writeFile("main_spelled.h", "\
+    #include \"spelled_once.h\"\n\
+    #include \"./spelled_once.h\"\n\
+    #include \"spelled_guarded.h\"\n\
+    #include \"./spelled_guarded.h\"\n");
+
+    rpp::pp_environment env;
+    rpp::pp preprocess(env);
+    rpp::pp_profile profile;
+    preprocess.set_profile(&profile);
+
+    std::string result;
+    preprocess.file(mainFile.toStdString(), rpp::pp_output_iterator<std::string>(result));
+    QCOMPARE(countOf(result, "int spelled_once;"), 1);
+    QCOMPARE(countOf(result, "int spelled_guarded;"), 1);
+
+    // the guarded header isn't opened again
+    int includes = 0;
+    int skipped = 0;
+    const rpp::pp_profile::file_map& files = profile.files();
+    for (rpp::pp_profile::file_map::const_iterator it = files.begin(); it != files.end(); ++it) {
+        if (it->first.find("spelled_guarded.h") != std::string::npos) {
+            includes += it->second.includes;
+            skipped += it->second.skipped;
+        }
+    }
+    QCOMPARE(includes, 1);
+    QCOMPARE(skipped, 1);
+}
+
+void TestPreprocessor::testMissingIncludeCached()
+{
+    QString mainFile = writeFile("main_missing.h", "\
+    #include \"nowhere.h\"\n\
+    #include \"nowhere.h\"\n\
+    int after_missing;\n");
+
+    rpp::pp_environment env;
+    rpp::pp preprocess(env);
+    std::string result;
+    preprocess.file(mainFile.toStdString(), rpp::pp_output_iterator<std::string>(result));
+    QVERIFY(result.find("int after_missing;") != std::string::npos);
+
+    // the failed lookup is remembered as well
+    QCOMPARE(preprocess.include_cache_misses(), 1);
+    QCOMPARE(preprocess.include_cache_hits(), 1);
+}
+
+void TestPreprocessor::testIncludePathAdded()
+{
+    writeFile("second/late.h", "int late;\n");
+    QString mainFile = writeFile("main_late.h", "#include <late.h>\n");
+
+    rpp::pp_environment env;
+    rpp::pp preprocess(env);
+    std::string result;
+    preprocess.file(mainFile.toStdString(), rpp::pp_output_iterator<std::string>(result));
+    QVERIFY(result.find("int late;") == std::string::npos);
+
+    // a new include path drops the failed lookup
+    preprocess.push_include_path(m_dir.absoluteFilePath("second").toStdString());
+    result.clear();
+    preprocess.file(mainFile.toStdString(), rpp::pp_output_iterator<std::string>(result));
+    QVERIFY(result.find("int late;") != std::string::npos);
+    QCOMPARE(preprocess.include_cache_misses(), 2);
+}
+
+void TestPreprocessor::testSymlinkedInclude()
+{
+#ifdef Q_OS_WIN
+    QSKIP("Symbolic links are not used for headers on Windows", SkipAll);
+#else
+    QString target = writeFile("link_target.h", "int link_target;\n");
+    QVERIFY(QFile::link(target, m_dir.absoluteFilePath("linked.h")));
+    QString mainFile = writeFile("main_linked.h", "#include \"linked.h\"\n");
+
+    // the directory listing tells a link from a directory, not from a file
+    rpp::pp_environment env;
+    rpp::pp preprocess(env);
+    std::string result;
+    preprocess.file(mainFile.toStdString(), rpp::pp_output_iterator<std::string>(result));
+    QCOMPARE(countOf(result, "int link_target;"), 1);
+#endif
+}
+
+static const rpp::pp_fast_string* macroName(rpp::pp_environment& env, int index)
+{
+    return env.symbols().get(QString("MACRO_%1").arg(index).toStdString());
+}
+
+void TestPreprocessor::testMacroTable()
+{
+    rpp::pp_environment env;
+    const int count = 10000; // enough to make the table grow a few times
+    for (int i = 0; i < count; ++i) {
+        rpp::pp_macro macro;
+        macro.definition = env.symbols().get(QString::number(i).toStdString());
+        env.bind(macroName(env, i), macro);
+    }
+    QCOMPARE(int(env.macro_count()), count);
+
+    // redefinition replaces the previous entry
+    rpp::pp_macro redefined;
+    redefined.definition = env.symbols().get(std::string("-1"));
+    env.bind(macroName(env, 42), redefined);
+    QCOMPARE(int(env.macro_count()), count);
+    QCOMPARE(std::string(env.resolve(macroName(env, 42))->definition->begin(), env.resolve(macroName(env, 42))->definition->end()), std::string("-1"));
+
+    // removing every other macro must not break the probe sequences of the remaining ones
+    for (int i = 0; i < count; i += 2)
+        env.unbind(macroName(env, i));
+    QCOMPARE(int(env.macro_count()), count / 2);
+    for (int i = 0; i < count; ++i) {
+        rpp::pp_macro* macro = env.resolve(macroName(env, i));
+        if (i % 2) {
+            QVERIFY(macro);
+            QCOMPARE(std::string(macro->definition->begin(), macro->definition->end()), QString::number(i).toStdString());
+        } else {
+            QVERIFY(!macro);
+        }
+    }
+    QVERIFY(!env.resolve("MACRO_1x", 8));
+}
+
+void TestPreprocessor::testEnvironmentSnapshot()
+{
+    rpp::pp_environment env;
+    rpp::pp_macro macro;
+    macro.definition = env.symbols().get(std::string("1"));
+    env.bind(macroName(env, 1), macro);
+    env.bind(macroName(env, 2), macro);
+    env.bind(macroName(env, 3), macro);
+    macro.definition = env.symbols().get(std::string("2"));
+    env.bind(macroName(env, 2), macro);
+    env.unbind(macroName(env, 3));
+
+    rpp::pp_environment snapshot(env);
+    QCOMPARE(snapshot.macro_count(), env.macro_count());
+    QVERIFY(snapshot.resolve(macroName(env, 1)));
+    QVERIFY(*snapshot.resolve(macroName(env, 2))->definition == *macro.definition);
+    QVERIFY(!snapshot.resolve(macroName(env, 3)));
+
+    // the snapshot doesn't share its macros with the original
+    snapshot.unbind(macroName(env, 1));
+    snapshot.bind(macroName(env, 4), macro);
+    QVERIFY(env.resolve(macroName(env, 1)));
+    QVERIFY(!env.resolve(macroName(env, 4)));
+}
+
+void TestPreprocessor::testSymbolInterning()
+{
+    rpp::pp_environment env;
+    const rpp::pp_fast_string* name = env.symbols().get(std::string("NAME"));
+    QCOMPARE(env.symbols().get(std::string("NAME")), name);
+    QVERIFY(env.symbols().get(std::string("OTHER_NAME")) != name);
+    QCOMPARE(int(env.symbols().count()), 2);
+
+    // names too long for the stack buffer are interned all the same
+    const std::string longName(2000, 'L');
+    const rpp::pp_fast_string* longSymbol = env.symbols().get(longName.begin(), longName.end());
+    QCOMPARE(std::string(longSymbol->begin(), longSymbol->end()), longName);
+    QCOMPARE(env.symbols().get(longName), longSymbol);
+    QCOMPARE(int(env.symbols().count()), 3);
+
+    // snapshots intern in the table of the original environment
+    rpp::pp_environment snapshot(env);
+    QCOMPARE(&snapshot.symbols(), &env.symbols());
+    QCOMPARE(snapshot.symbols().get(std::string("NAME")), name);
+
+    // every environment has a table of its own
+    rpp::pp_environment other;
+    QVERIFY(other.symbols().get(std::string("NAME")) != name);
+}
+
+void TestPreprocessor::testDefineWithTrailingComment()
+{
+    QString mainFile = writeFile("main_comment.h", "\
+    #define VALUE 1 // one\n\
+    #define OTHER 2 /* two */\n\
+    int value = VALUE;\n\
+    int other = OTHER;\n");
+
+    rpp::pp_environment env;
+    std::string result = preprocessFile(env, mainFile);
+    QVERIFY(result.find("int value = 1 ;") != std::string::npos);
+    QVERIFY(result.find("int other = 2 ;") != std::string::npos);
+    QCOMPARE(countOf(result, "int value"), 1);
+}
+
+template <typename Skipper>
+static void compareScanners(const std::string& text)
+{
+    // the pointer overloads must stop where the generic ones do
+    Skipper generic, fast;
+    std::string::const_iterator expected = generic(text.begin(), text.end());
+    const char* result = fast(text.data(), text.data() + text.size());
+    QCOMPARE(int(result - text.data()), int(expected - text.begin()));
+    QCOMPARE(fast.lines, generic.lines);
+}
+
+void TestPreprocessor::testScannerFastPaths()
+{
+    // long enough to be scanned in several chunks
+    const std::string padding(40, 'x');
+    const char* comments[] = {
+        "/", "/a", "//", "// comment\nnext", "/* comment */next", "/**/", "/* unterminated",
+        "/* a\n b\n c */", "/* ** / **/x", "/* *\n*/", "/***/", 0
+    };
+    const char* strings[] = {
+        "\"\"", "\"text\" next", "\"escaped \\\" quote\"", "\"backslash \\\\\"x",
+        "\"continued \\\n line\"", "\"unterminated", "\"ends with \\", 0
+    };
+
+    for (int i = 0; comments[i]; ++i) {
+        std::string text(comments[i]);
+        compareScanners<rpp::pp_skip_comment_or_divop>(text);
+        text.insert(std::min<std::size_t>(text.size(), 2), padding);
+        compareScanners<rpp::pp_skip_comment_or_divop>(text);
+        compareScanners<rpp::pp_skip_comment_or_divop>(text + padding);
+    }
+
+    for (int i = 0; strings[i]; ++i) {
+        std::string text(strings[i]);
+        compareScanners<rpp::pp_skip_string_literal>(text);
+        text.insert(1, padding);
+        compareScanners<rpp::pp_skip_string_literal>(text);
+        compareScanners<rpp::pp_skip_string_literal>(text + padding);
+    }
+
+    QCOMPARE(rpp::pp_find_any(padding.data(), padding.data() + padding.size(), "ab"),
+             padding.data() + padding.size());
+    std::string text = padding + "b" + padding;
+    QCOMPARE(rpp::pp_find_any(text.data(), text.data() + text.size(), "ab"), text.data() + padding.size());
+}
+
+void TestPreprocessor::testProfile()
+{
+    const char* header = "\
+    #ifndef PROFILED_H\n\
+    #define PROFILED_H\n\
+    #define TWICE(x) x x\n\
+    #define ANSWER 42\n\
+    #endif\n";
+    QString headerFile = writeFile("profiled.h", header);
+    QString mainFile = writeFile("main_profiled.cpp", "\
+    #include \"profiled.h\"\n\
+    #include \"profiled.h\"\n\
+    int a = TWICE(ANSWER);\n\
+    int b = ANSWER;\n");
+
+    rpp::pp_environment env;
+    rpp::pp preprocess(env);
+    rpp::pp_profile profile;
+    preprocess.set_profile(&profile);
+
+    std::string result;
+    preprocess.file(mainFile.toStdString(), rpp::pp_output_iterator<std::string>(result));
+
+    const rpp::pp_profile::file_map& files = profile.files();
+    QCOMPARE(int(files.size()), 2);
+    const rpp::pp_file_profile& main = files.find(mainFile.toStdString())->second;
+    QCOMPARE(main.includes, 1);
+    QCOMPARE(main.skipped, 0);
+    QCOMPARE(main.depth, 0);
+    QCOMPARE(int(main.bytes_read), int(QFile(mainFile).size()));
+
+    // the guard is recognized, the second include doesn't open the file
+    // and is counted apart
+    rpp::pp_profile::file_map::const_iterator it = files.begin();
+    const rpp::pp_file_profile& included = it->first == mainFile.toStdString() ? (++it)->second : it->second;
+    QCOMPARE(included.includes, 1);
+    QCOMPARE(included.skipped, 1);
+    QCOMPARE(included.depth, 1);
+    QCOMPARE(int(included.bytes_read), int(qstrlen(header)));
+
+    std::size_t emitted = 0;
+    for (it = files.begin(); it != files.end(); ++it) {
+        emitted += it->second.bytes_emitted;
+        QVERIFY(it->second.time <= it->second.total_time);
+    }
+    QCOMPARE(int(emitted), int(result.size()));
+
+    const rpp::pp_profile::macro_map& macros = profile.macros();
+    QCOMPARE(macros.find("ANSWER")->second.expansions, 2);
+    QCOMPARE(macros.find("TWICE")->second.expansions, 1);
+    QCOMPARE(int(macros.find("TWICE")->second.generated_bytes), int(qstrlen("42 42")));
+
+    std::ostringstream json;
+    profile.write_json(json, env.symbols().count());
+    QVERIFY(json.str().find("\"macro\": \"TWICE\", \"expansions\": 1") != std::string::npos);
+    QVERIFY(json.str().find("\"includes\": 1, \"skipped\": 1, \"depth\": 1") != std::string::npos);
+}
+
+// Keeps every name looked up, in order, and how many of them are macros.
+class LookupRecorder : public rpp::pp_macro_observer
+{
+public:
+    LookupRecorder() : hits(0) {}
+
+    virtual void macro_resolved(const rpp::pp_fast_string& name, const rpp::pp_macro* macro)
+    {
+        names.push_back(std::string(name.begin(), name.end()));
+        hits += macro != 0;
+    }
+    virtual void macro_bound(const rpp::pp_macro&) {}
+    virtual void macro_unbound(const rpp::pp_fast_string&) {}
+
+    std::vector<std::string> names;
+    int hits;
+};
+
+void TestPreprocessor::benchmarkMacroLookup()
+{
+    // the macros and lookups of the Qt GUI module, headers as found
+    QString headers = QLibraryInfo::location(QLibraryInfo::HeadersPath);
+    if (!QFile::exists(headers + "/QtGui/QtGui"))
+        QSKIP("The Qt headers are not installed", SkipAll);
+
+    QFile config(":/trolltech/generator/pp-qt-configuration");
+    QVERIFY(config.open(QFile::ReadOnly));
+    QByteArray configuration = config.readAll();
+
+    rpp::pp_environment env;
+    LookupRecorder recorder;
+    env.set_observer(&recorder);
+    rpp::pp preprocess(env);
+    rpp::pp_null_output_iterator null_out;
+    preprocess(configuration.constData(), configuration.constData() + configuration.size(), null_out);
+    preprocess.push_include_path(headers.toStdString());
+    preprocess.push_include_path((headers + "/QtCore").toStdString());
+    preprocess.push_include_path((headers + "/QtGui").toStdString());
+    preprocess.file((headers + "/QtGui/QtGui").toStdString(), null_out);
+    env.set_observer(0);
+    QVERIFY(recorder.hits > 0);
+
+    qDebug("%d macros in %d slots, load factor %.2f; %d lookups, %.1f%% of them macros",
+           int(env.macro_count()), int(env.table_size()), double(env.macro_count()) / env.table_size(),
+           int(recorder.names.size()), 100.0 * recorder.hits / recorder.names.size());
+
+    // replay the lookups in the order the preprocessor made them
+    std::vector<const rpp::pp_fast_string*> names;
+    names.reserve(recorder.names.size());
+    for (std::size_t i = 0; i < recorder.names.size(); ++i)
+        names.push_back(env.symbols().get(recorder.names[i]));
+
+    int found = 0;
+    QBENCHMARK {
+        for (std::size_t i = 0; i < names.size(); ++i)
+            found += env.resolve(names[i]) != 0;
+    }
+    QVERIFY(found > 0);
+}
+
+QTEST_APPLESS_MAIN(TestPreprocessor)
+
+#include "testpreprocessor.moc"
@@ -0,0 +1,58 @@
+/*
+* This file is part of the API Extractor project.
+*
+* Copyright (C) 2011 Nokia Corporation and/or its subsidiary(-ies).
+*
+* Contact: PySide team <contact@pyside.org>
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* version 2 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+* 02110-1301 USA
+*
+*/
+
+#ifndef TESTPREPROCESSOR_H
+#define TESTPREPROCESSOR_H
+
+#include <QObject>
+#include <QDir>
+
+class TestPreprocessor : public QObject
+{
+    Q_OBJECT
+    private slots:
+        void initTestCase();
+        void cleanupTestCase();
+        void testCacheReplay();
+        void testCacheInvalidatedByMacro();
+        void testCacheInvalidatedByInclude();
+        void testCacheStoresOwnOutput();
+        void testPragmaOnce();
+        void testPartialIncludeGuard();
+        void testIncludeSpellings();
+        void testMissingIncludeCached();
+        void testIncludePathAdded();
+        void testSymlinkedInclude();
+        void testMacroTable();
+        void testEnvironmentSnapshot();
+        void testSymbolInterning();
+        void testDefineWithTrailingComment();
+        void testScannerFastPaths();
+        void testProfile();
+        void benchmarkMacroLookup();
+    private:
+        QString writeFile(const QString& fileName, const char* contents);
+        QDir m_dir;
+};
+
+#endif
@@ -0,0 +1,110 @@
+/*
+* This file is part of the API Extractor project.
+*
+* Copyright (C) 2009 Nokia Corporation and/or its subsidiary(-ies).
+*
+* Contact: PySide team <contact@pyside.org>
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* version 2 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+* 02110-1301 USA
+*
+*/
+
+
+#include "testskipfunctionbody.h"
+#include <QtTest/QTest>
+#include <QBuffer>
+#include "abstractmetabuilder.h"
+#include "typedatabase.h"
+#include "reporthandler.h"
+
+static AbstractMetaBuilder* buildModel(const char* cppCode, const char* xmlCode, bool skipFunctionBodies)
+{
+    ReportHandler::setSilent(true);
+    TypeDatabase* td = TypeDatabase::instance(true);
+    QBuffer buffer;
+    buffer.setData(xmlCode);
+    td->parseFile(&buffer);
+    buffer.close();
+
+    AbstractMetaBuilder* builder = new AbstractMetaBuilder;
+    builder->setSkipFunctionBodies(skipFunctionBodies);
+    buffer.setData(cppCode);
+    builder->build(&buffer);
+    return builder;
+}
+
+static QStringList functionNames(AbstractMetaBuilder* builder, const char* className)
+{
+    QStringList names;
+    foreach (AbstractMetaFunction* func, builder->classes().findClass(className)->functions())
+        names << func->minimalSignature();
+    names.sort();
+    return names;
+}
+
+void TestSkipFunctionBody::testInlineMethodsAreKept()
+{
+    const char* cppCode = "\
+    struct A {\n\
+        A() : m_value(0) { if (m_value) { m_value = 1; } }\n\
+        int value() const { return m_value; }\n\
+        void setValue(int value) { const char* s = \"}\"; m_value = value; }\n\
+        int m_value;\n\
+    };\n";
+    const char* xmlCode = "\
+    <typesystem package=\"Foo\">\n\
+        <primitive-type name='int'/>\n\
+        <primitive-type name='char'/>\n\
+        <value-type name='A'/>\n\
+    </typesystem>\n";
+
+    AbstractMetaBuilder* parsed = buildModel(cppCode, xmlCode, false);
+    AbstractMetaBuilder* skipped = buildModel(cppCode, xmlCode, true);
+    QVERIFY(functionNames(skipped, "A").contains("setValue(int)"));
+    QCOMPARE(functionNames(skipped, "A"), functionNames(parsed, "A"));
+    delete parsed;
+    delete skipped;
+}
+
+void TestSkipFunctionBody::testDeclarationsAfterSkippedBodies()
+{
+    const char* cppCode = "\
+    struct A {\n\
+        void method() {\n\
+            struct Local { void f() {} };\n\
+            for (int i = 0; i < 10; ++i) { { } }\n\
+        }\n\
+    };\n\
+    void function() { int a[] = { 1, 2 }; }\n\
+    struct B { void method() {} };\n";
+    const char* xmlCode = "\
+    <typesystem package=\"Foo\">\n\
+        <primitive-type name='int'/>\n\
+        <value-type name='A'/>\n\
+        <value-type name='B'/>\n\
+    </typesystem>\n";
+
+    AbstractMetaBuilder* builder = buildModel(cppCode, xmlCode, true);
+    AbstractMetaClassList classes = builder->classes();
+    QCOMPARE(classes.count(), 2);
+    QVERIFY(classes.findClass("A")->findFunction("method"));
+    QVERIFY(classes.findClass("B")->findFunction("method"));
+    QVERIFY(!classes.findClass("Local"));
+    delete builder;
+}
+
+QTEST_APPLESS_MAIN(TestSkipFunctionBody)
+
+#include "testskipfunctionbody.moc"
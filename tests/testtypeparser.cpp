@@ -0,0 +1,180 @@
+/*
+* This file is part of the API Extractor project.
+*
+* Copyright (C) 2009 Nokia Corporation and/or its subsidiary(-ies).
+*
+* Contact: PySide team <contact@pyside.org>
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* version 2 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+* 02110-1301 USA
+*
+*/
+
+
+
+#include "testtypeparser.h"
+#include <QtTest/QTest>
+#include <QFile>
+#include <QLibraryInfo>
+#include <QTime>
+#include "typeparser.h"
+#include "parser/binder.h"
+#include "parser/codemodel.h"
+#include "parser/control.h"
+#include "parser/parser.h"
+#include "parser/rpp/pp.h"
+
+static bool sameInfo(const TypeParser::Info &a, const TypeParser::Info &b)
+{
+    if (a.qualified_name != b.qualified_name || a.arrays != b.arrays
+        || a.is_reference != b.is_reference || a.is_constant != b.is_constant
+        || a.is_busted != b.is_busted || a.indirections != b.indirections
+        || a.template_instantiations.size() != b.template_instantiations.size())
+        return false;
+
+    for (int i = 0; i < a.template_instantiations.size(); ++i) {
+        if (!sameInfo(a.template_instantiations.at(i), b.template_instantiations.at(i)))
+            return false;
+    }
+    return true;
+}
+
+static TypeInfo typeInfo(const QString &name, int indirections = 0, bool constant = false, bool reference = false,
+                         const QStringList &arrays = QStringList())
+{
+    TypeInfo type;
+    type.setQualifiedName(name.split("::"));
+    type.setIndirections(indirections);
+    type.setConstant(constant);
+    type.setReference(reference);
+    type.setArrayElements(arrays);
+    return type;
+}
+
+void TestTypeParser::testTypeInfoConversion()
+{
+    QList<TypeInfo> types;
+    types << typeInfo("int")
+          << typeInfo("unsigned long int", 1)
+          << typeInfo("QString", 0, true, true)
+          << typeInfo("Qt::Orientation")
+          << typeInfo("char", 2, true)
+          << typeInfo("QList<QString >", 0, true, true)
+          << typeInfo("QMap<QString,QList<const QObject*> >", 1)
+          << typeInfo("QHash<QString, int>::const_iterator")
+          << typeInfo("std::pair<int,Qt::Orientation>")
+          << typeInfo("QFlags<Qt::AlignmentFlag>", 0, true, true)
+          << typeInfo("float", 0, false, false, QStringList() << "16")
+          << typeInfo("int", 1, false, false, QStringList() << "N" << "" << "4")
+          << typeInfo("double", 0, false, false, QStringList() << "")
+          << typeInfo("")
+          << typeInfo("unsigned  int")
+          << typeInfo("QList< ns::A >");
+
+    TypeInfo volatileType = typeInfo("int", 1);
+    volatileType.setVolatile(true);
+    types << volatileType;
+
+    TypeInfo functionPointer = typeInfo("void", 1);
+    functionPointer.setFunctionPointer(true);
+    functionPointer.setArguments(QList<TypeInfo>() << typeInfo("int"));
+    types << functionPointer;
+
+    foreach (const TypeInfo &type, types) {
+        TypeParser::Info info = TypeParser::parse(type);
+        QVERIFY2(sameInfo(info, TypeParser::parse(type.toString())), qPrintable(type.toString()));
+    }
+
+    TypeParser::Info map = TypeParser::parse(types.at(6));
+    QCOMPARE(map.qualified_name, QStringList() << "QMap");
+    QCOMPARE(map.template_instantiations.size(), 2);
+    QCOMPARE(map.template_instantiations.last().template_instantiations.first().indirections, uint(1));
+}
+
+static void collectTypes(ScopeModelItem scope, QList<TypeInfo> *types)
+{
+    foreach (FunctionModelItem function, scope->functions()) {
+        types->append(function->type());
+        foreach (ArgumentModelItem argument, function->arguments())
+            types->append(argument->type());
+    }
+    foreach (VariableModelItem variable, scope->variables())
+        types->append(variable->type());
+    foreach (ClassModelItem item, scope->classes())
+        collectTypes(model_static_cast<ScopeModelItem>(item), types);
+
+    if (NamespaceModelItem ns = model_dynamic_cast<NamespaceModelItem>(scope)) {
+        foreach (NamespaceModelItem item, ns->namespaces())
+            collectTypes(model_static_cast<ScopeModelItem>(item), types);
+    }
+}
+
+void TestTypeParser::benchmarkTypeInfoConversion()
+{
+    // the argument, return and field types of the Qt GUI module
+    QString headers = QLibraryInfo::location(QLibraryInfo::HeadersPath);
+    if (!QFile::exists(headers + "/QtGui/QtGui"))
+        QSKIP("The Qt headers are not installed", SkipAll);
+
+    rpp::pp_environment env;
+    rpp::pp preprocess(env);
+    preprocess.push_include_path(headers.toStdString());
+    preprocess.push_include_path((headers + "/QtCore").toStdString());
+    preprocess.push_include_path((headers + "/QtGui").toStdString());
+    std::string text;
+    preprocess.file((headers + "/QtGui/QtGui").toStdString(), rpp::pp_output_iterator<std::string>(text));
+
+    Control control;
+    Parser parser(&control);
+    pool p;
+    TranslationUnitAST *ast = parser.parse(text.c_str(), text.size(), &p);
+    CodeModel model;
+    Binder binder(&model, parser.location());
+    FileModelItem dom = binder.run(ast);
+
+    QList<TypeInfo> types;
+    collectTypes(model_static_cast<ScopeModelItem>(dom), &types);
+    QVERIFY(types.size() > 10000);
+
+    int bestText = 0;
+    int bestParts = 0;
+    for (int round = 0; round < 5; ++round) {
+        QList<TypeParser::Info> infos;
+        QTime timer;
+        timer.start();
+        foreach (const TypeInfo &type, types)
+            infos << TypeParser::parse(type.toString());
+        int elapsed = timer.elapsed();
+        if (!round || elapsed < bestText)
+            bestText = elapsed;
+
+        QList<TypeParser::Info> direct;
+        timer.start();
+        foreach (const TypeInfo &type, types)
+            direct << TypeParser::parse(type);
+        elapsed = timer.elapsed();
+        if (!round || elapsed < bestParts)
+            bestParts = elapsed;
+
+        for (int i = 0; i < types.size(); ++i)
+            QVERIFY2(sameInfo(direct.at(i), infos.at(i)), qPrintable(types.at(i).toString()));
+    }
+
+    qDebug("%d types: %.0f ns a type as text, %.0f ns from their parts", types.size(),
+           bestText * 1e6 / types.size(), bestParts * 1e6 / types.size());
+}
+
+QTEST_APPLESS_MAIN(TestTypeParser)
+
+#include "testtypeparser.moc"
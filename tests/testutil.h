@@ -38,6 +38,8 @@ public:
     {
         ReportHandler::setSilent(silent);
         m_builder = new AbstractMetaBuilder;
+        // every test runs with and without the type cache, see CMakeLists.txt
+        m_builder->setTypeCaching(qgetenv("APIEXTRACTOR_NO_TYPE_CACHE").isEmpty());
         TypeDatabase* td = TypeDatabase::instance(true);
         if (apiVersion)
             td->setApiVersion("*", apiVersion);
@@ -22,6 +22,7 @@
  */
 
 #include "typeparser.h"
+#include "parser/codemodel.h"
 
 #include <QtCore/QDebug>
 #include <QtCore/QStack>
@@ -233,6 +234,94 @@ TypeParser::Info TypeParser::parse(const QString &str)
     return info;
 }
 
+// an identifier the scanner reads as such, not as a keyword
+static bool isIdentifier(const QChar *chars, int length)
+{
+    if (!length)
+        return false;
+
+    for (int i = 0; i < length; ++i) {
+        if (!chars[i].isLetterOrNumber() && chars[i] != '_')
+            return false;
+    }
+
+    return !(length == 5 && QString::fromRawData(chars, length) == QLatin1String("const"));
+}
+
+// identifiers with single spaces between them, which the parser joins
+// into a name just the same
+static bool isName(const QString &s, int length)
+{
+    const QChar *chars = s.constData();
+    int start = 0;
+    for (int i = 0; i <= length; ++i) {
+        if (i == length || chars[i] == ' ') {
+            if (!isIdentifier(chars + start, i - start))
+                return false;
+            start = i + 1;
+        }
+    }
+
+    return true;
+}
+
+// a name and its template arguments, which end the part and are balanced
+static bool isTemplateId(const QString &s)
+{
+    int open = s.indexOf('<');
+    return open > 0 && s.endsWith('>') && s.count('<') == s.count('>') && isName(s, open);
+}
+
+TypeParser::Info TypeParser::parse(const TypeInfo &type)
+{
+    if (type.isFunctionPointer())
+        return parse(type.toString());
+
+    Info info;
+
+    QStringList qualifiedName = type.qualifiedName();
+    for (int i = 0; i < qualifiedName.size(); ++i) {
+        const QString &part = qualifiedName.at(i);
+        if (isName(part, part.length())) {
+            info.qualified_name << part;
+        } else if (i == qualifiedName.size() - 1 && isTemplateId(part)) {
+            Info id = parse(part);
+            if (id.is_busted)
+                return id;
+            info.qualified_name += id.qualified_name;
+            info.template_instantiations = id.template_instantiations;
+        } else {
+            return parse(type.toString());
+        }
+    }
+
+    info.is_constant = type.isConstant();
+
+    // read as a name after the type's
+    if (type.isVolatile()) {
+        if (info.qualified_name.isEmpty())
+            info.qualified_name << QLatin1String("volatile");
+        else
+            info.qualified_name.last() += QLatin1String(" volatile");
+    }
+
+    info.indirections = type.indirections();
+    info.is_reference = type.isReference();
+
+    // an array of unspecified size takes the size of the array before it
+    QString array;
+    foreach (const QString &element, type.arrayElements()) {
+        if (!element.isEmpty()) {
+            if (!isIdentifier(element.constData(), element.length()))
+                return parse(type.toString());
+            array = element;
+        }
+        info.arrays << array;
+    }
+
+    return info;
+}
+
 QString TypeParser::Info::instantiationName() const
 {
     QString s(qualified_name.join("::"));
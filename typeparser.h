@@ -28,6 +28,8 @@
 #include <QtCore/QString>
 #include <QtCore/QStringList>
 
+class TypeInfo;
+
 class TypeParser
 {
 public:
@@ -47,6 +49,15 @@ public:
     };
 
     static Info parse(const QString &str);
+
+    /**
+    *   The same as parse(type.toString()), made from the parts of \a type
+    *   without writing it out. The code model keeps template arguments as
+    *   text, so only they are parsed; the few types that the scanner would
+    *   read differently from their parts, like array sizes that are not
+    *   names or numbers, are parsed as text.
+    */
+    static Info parse(const TypeInfo &type);
 };
 
 #endif // TYPEPARSER_H